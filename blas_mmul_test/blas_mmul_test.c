@@ -4,26 +4,71 @@
    variants with and without threading inside the BLAS gemm routine,
    to see how much speedup can be achieved from threading.
 
+   The built-in SIMD kernel from ../common/simd_gemm.c is also timed,
+   as a third contender for nodes where no tuned BLAS is available.
+   An optional third argument gives the number of repetitions of the
+   second BLAS gemm call and of the simd_dgemm call; median times are
+   then used.
+
+   In sweep mode several BLAS shared libraries are loaded with dlopen
+   in one run, and dgemm is timed for each of them for a list of
+   matrix sizes and BLAS thread counts, for example:
+   ./blas_mmul_test sweep libopenblas.so,libmkl_rt.so,libblis.so 1000,2000,4000 1,2,4,8 5
+   GFLOP/s, parallel efficiency relative to the first thread count and
+   the run-to-run coefficient of variation are reported per backend.
+   The thread count is set with openblas_set_num_threads,
+   MKL_Set_Num_Threads or bli_thread_set_num_threads, whichever the
+   library has; other libraries are run with their default threads.
+   The libraries are loaded with RTLD_DEEPBIND, so that each one
+   resolves its internal symbols (xerbla_, lsame_ and so on) to its
+   own definitions rather than to the BLAS this program is linked with.
+   Backends are labelled by the path given, so give full paths to tell
+   libraries with the same file name apart.
+
+   In variants mode sgemm, dgemm, cgemm and zgemm are timed with all
+   four transpose combinations for a list of M x N x K shapes, so that
+   tall-skinny and rank-k update shapes can be tested, for example:
+   ./blas_mmul_test variants 4000x4000x64,8000x64x64,1000x1000x1000 5
+   Each variant is verified separately by computing some elements of
+   C in double precision.
+
+   Compile for example like this:
+   gcc -O2 -I../common blas_mmul_test.c ../common/simd_gemm.c ../common/bench_timing.c -lopenblas -lm -ldl
+
    Written by Elias Rudberg.
 */
 
-#include <sys/time.h>
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <float.h>
+#include <complex.h>
+#include <dlfcn.h>
+#include "simd_gemm.h"
+#include "bench_timing.h"
 
 void dgemm_(const char *ta,const char *tb,
 	    const int *n, const int *k, const int *l,
 	    const double *alpha,const double *A,const int *lda,
 	    const double *B, const int *ldb,
 	    const double *beta, double *C, const int *ldc);
-
-static double get_wall_seconds() {
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  double seconds = tv.tv_sec + (double)tv.tv_usec / 1000000;
-  return seconds;
-}
+void sgemm_(const char *ta,const char *tb,
+	    const int *n, const int *k, const int *l,
+	    const float *alpha,const float *A,const int *lda,
+	    const float *B, const int *ldb,
+	    const float *beta, float *C, const int *ldc);
+void cgemm_(const char *ta,const char *tb,
+	    const int *n, const int *k, const int *l,
+	    const float complex *alpha,const float complex *A,const int *lda,
+	    const float complex *B, const int *ldb,
+	    const float complex *beta, float complex *C, const int *ldc);
+void zgemm_(const char *ta,const char *tb,
+	    const int *n, const int *k, const int *l,
+	    const double complex *alpha,const double complex *A,const int *lda,
+	    const double complex *B, const int *ldb,
+	    const double complex *beta, double complex *C, const int *ldc);
 
 /* When calling this routine, A is supposed to point to an array of
    n*n double numbers. */
@@ -77,6 +122,43 @@ static void verify_mmul_result(const double* A,
   printf("verify_mmul_result, verified %d elements, maxabsdiff = %g\n", count, maxabsdiff);
 }
 
+/* GFLOP/s for one n x n matrix-matrix multiplication taking the
+   given number of seconds. */
+static double get_gflops(int n, double seconds) {
+  return 2.0 * n * n * n / seconds / 1e9;
+}
+
+typedef struct {
+  int n;
+  const double* A;
+  const double* B;
+  double* C;
+  int useSimd;
+  int failed;
+} GemmArgs;
+
+/* Computes C = A*B with BLAS dgemm or simd_dgemm, for bench_repeat. */
+static void gemm_func(void* arg) {
+  GemmArgs* g = (GemmArgs*)arg;
+  double alpha = 1;
+  double beta = 0;
+  if(g->useSimd) {
+    if(simd_dgemm('T', 'T', g->n, g->n, g->n, g->A, g->n, g->B, g->n, beta, g->C, g->n) != 0)
+      g->failed = 1;
+  }
+  else
+    dgemm_("T", "T", &g->n, &g->n, &g->n, &alpha, g->A, &g->n, g->B, &g->n, &beta, g->C, &g->n);
+}
+
+/* Records one timing in the BENCH_RESULTS file, if set. */
+static void write_single_result(const char* benchmark, int n, double seconds) {
+  BenchStats stats;
+  char params[64];
+  bench_compute_stats(&seconds, 1, &stats);
+  snprintf(params, sizeof(params), "n=%d", n);
+  bench_write_result("blas_mmul_test", benchmark, params, &stats);
+}
+
 double compare_matrices(const double* A,
 			const double* B,
 			int n) {
@@ -90,15 +172,413 @@ double compare_matrices(const double* A,
   return maxabsdiff;
 }
 
+typedef void (*dgemm_func_t)(const char *ta,const char *tb,
+			     const int *n, const int *k, const int *l,
+			     const double *alpha,const double *A,const int *lda,
+			     const double *B, const int *ldb,
+			     const double *beta, double *C, const int *ldc);
+
+typedef struct {
+  const char* name;
+  void* handle;
+  dgemm_func_t dgemm;
+  // Thread count setter, whichever of the known ones the library has
+  void (*setThreadsInt)(int);
+  void (*setThreadsLong)(long);
+} BlasBackend;
+
+/* Loads a BLAS shared library with its own symbol namespace, so that
+   several BLAS libraries can be used in the same run. Returns 0 on
+   success, path must stay valid while the backend is used. */
+static int load_blas_backend(const char* path, BlasBackend* backend) {
+  memset(backend, 0, sizeof(BlasBackend));
+  backend->name = path;
+  int flags = RTLD_NOW | RTLD_LOCAL;
+#ifdef RTLD_DEEPBIND
+  // Prefer the library's own symbols over those of the linked BLAS
+  flags |= RTLD_DEEPBIND;
+#else
+  printf("Warning: RTLD_DEEPBIND not available, '%s' may use symbols of the linked BLAS.\n", path);
+#endif
+  backend->handle = dlopen(path, flags);
+  if(!backend->handle) {
+    printf("Error: dlopen failed for '%s': %s\n", path, dlerror());
+    return -1;
+  }
+  backend->dgemm = (dgemm_func_t)dlsym(backend->handle, "dgemm_");
+  if(!backend->dgemm) {
+    printf("Error: no dgemm_ symbol in '%s'.\n", path);
+    dlclose(backend->handle);
+    backend->handle = NULL;
+    return -1;
+  }
+  backend->setThreadsInt = (void (*)(int))dlsym(backend->handle, "openblas_set_num_threads");
+  if(!backend->setThreadsInt)
+    backend->setThreadsInt = (void (*)(int))dlsym(backend->handle, "MKL_Set_Num_Threads");
+  backend->setThreadsLong = (void (*)(long))dlsym(backend->handle, "bli_thread_set_num_threads");
+  return 0;
+}
+
+static void unload_blas_backends(BlasBackend* backends, int nBackends) {
+  int i;
+  for(i = 0; i < nBackends; i++)
+    dlclose(backends[i].handle);
+}
+
+/* Returns 0 if the backend has no known way to set the thread count. */
+static int set_blas_threads(BlasBackend* backend, int nThreads) {
+  if(backend->setThreadsInt)
+    backend->setThreadsInt(nThreads);
+  else if(backend->setThreadsLong)
+    backend->setThreadsLong(nThreads);
+  else
+    return 0;
+  return 1;
+}
+
+/* Parses a comma-separated list of positive integers. Returns the
+   number of values, or -1 on error. */
+static int parse_int_list(const char* str, int* values, int maxValues) {
+  int count = 0;
+  const char* p = str;
+  while(*p) {
+    char* end;
+    long value = strtol(p, &end, 10);
+    if(end == p || value <= 0 || count == maxValues)
+      return -1;
+    values[count++] = (int)value;
+    if(*end == ',')
+      end++;
+    else if(*end != '\0')
+      return -1;
+    p = end;
+  }
+  return count;
+}
+
+typedef struct {
+  BlasBackend* backend;
+  int n;
+  const double* A;
+  const double* B;
+  double* C;
+} BackendGemmArgs;
+
+static void backend_gemm_func(void* arg) {
+  BackendGemmArgs* g = (BackendGemmArgs*)arg;
+  double alpha = 1;
+  double beta = 0;
+  g->backend->dgemm("T", "T", &g->n, &g->n, &g->n, &alpha, g->A, &g->n, g->B, &g->n, &beta, g->C, &g->n);
+}
+
+/* Sweep mode: for each BLAS library, matrix size and thread count,
+   time nRepetitions dgemm calls (after one warm-up call) and report
+   GFLOP/s from the median time, parallel efficiency relative to the
+   smallest thread count, and the run-to-run coefficient of variation.
+   Each result is checked against the first backend's result. */
+static int do_backend_sweep(const char* libList, const char* sizeList, const char* threadList, int nRepetitions) {
+  const int maxValues = 64;
+  int sizes[maxValues], threadCounts[maxValues];
+  int nSizes = parse_int_list(sizeList, sizes, maxValues);
+  int nThreadCounts = parse_int_list(threadList, threadCounts, maxValues);
+  if(nSizes <= 0 || nThreadCounts <= 0) {
+    printf("Error: sizes and thread counts must be comma-separated lists of positive integers.\n");
+    return -1;
+  }
+  BlasBackend backends[maxValues];
+  int nBackends = 0;
+  char* libListCopy = strdup(libList);
+  char* path;
+  for(path = strtok(libListCopy, ","); path; path = strtok(NULL, ",")) {
+    if(nBackends == maxValues || load_blas_backend(path, &backends[nBackends]) != 0) {
+      unload_blas_backends(backends, nBackends);
+      free(libListCopy);
+      return -1;
+    }
+    nBackends++;
+  }
+  int i;
+  for(i = 0; i < nBackends; i++) {
+    if(!backends[i].setThreadsInt && !backends[i].setThreadsLong)
+      printf("Note: %s has no known thread count function, it is run once per size with its default threads.\n", backends[i].name);
+  }
+  double* times = (double*)malloc(nRepetitions*sizeof(double));
+  printf("# %-24s %6s %7s %12s %10s %10s %8s %12s\n", "backend", "n", "threads", "median_s",
+	 "GFLOP/s", "par_eff", "cv_%", "max_abs_diff");
+  int sizeIdx;
+  for(sizeIdx = 0; sizeIdx < nSizes; sizeIdx++) {
+    int n = sizes[sizeIdx];
+    double* A = (double*)malloc((size_t)n*n*sizeof(double));
+    double* B = (double*)malloc((size_t)n*n*sizeof(double));
+    double* C = (double*)malloc((size_t)n*n*sizeof(double));
+    double* C_ref = (double*)malloc((size_t)n*n*sizeof(double));
+    fill_matrix_with_random_numbers(n, A);
+    fill_matrix_with_random_numbers(n, B);
+    int backendIdx;
+    for(backendIdx = 0; backendIdx < nBackends; backendIdx++) {
+      BlasBackend* backend = &backends[backendIdx];
+      int canSetThreads = backend->setThreadsInt || backend->setThreadsLong;
+      double gflops_first = 0;
+      int threadIdx;
+      for(threadIdx = 0; threadIdx < (canSetThreads ? nThreadCounts : 1); threadIdx++) {
+	int nThreads = threadCounts[threadIdx];
+	if(canSetThreads)
+	  set_blas_threads(backend, nThreads);
+	BackendGemmArgs args = { backend, n, A, B, C };
+	bench_repeat(backend_gemm_func, &args, 1, nRepetitions, times);
+	BenchStats stats;
+	bench_compute_stats(times, nRepetitions, &stats);
+	double gflops = get_gflops(n, stats.median);
+	// Efficiency relative to the first thread count in the list
+	if(threadIdx == 0)
+	  gflops_first = gflops;
+	double parallelEfficiency = gflops / gflops_first * threadCounts[0] / nThreads;
+	if(backendIdx == 0 && threadIdx == 0)
+	  memcpy(C_ref, C, (size_t)n*n*sizeof(double));
+	double maxAbsDiff = compare_matrices(C_ref, C, n);
+	char threadsStr[16];
+	if(canSetThreads)
+	  snprintf(threadsStr, sizeof(threadsStr), "%d", nThreads);
+	else
+	  snprintf(threadsStr, sizeof(threadsStr), "default");
+	printf("  %-24s %6d %7s %12.6f %10.3f %10.3f %8.2f %12.3g\n", backend->name, n, threadsStr, stats.median,
+	       gflops, canSetThreads ? parallelEfficiency : 1.0, 100 * stats.stddev / stats.mean, maxAbsDiff);
+	if(maxAbsDiff > 1e-4 * n) {
+	  printf("Error: result of %s differs from result of %s.\n", backend->name, backends[0].name);
+	  free(A);
+	  free(B);
+	  free(C);
+	  free(C_ref);
+	  free(times);
+	  unload_blas_backends(backends, nBackends);
+	  free(libListCopy);
+	  return -1;
+	}
+	char params[256];
+	snprintf(params, sizeof(params), "backend=%s n=%d threads=%s", backend->name, n, threadsStr);
+	bench_write_result("blas_mmul_test", "dgemm_sweep", params, &stats);
+      }
+    }
+    free(A);
+    free(B);
+    free(C);
+    free(C_ref);
+  }
+  unload_blas_backends(backends, nBackends);
+  free(times);
+  free(libListCopy);
+  printf("blas_mmul_test sweep finished OK.\n");
+  return 0;
+}
+
+/* Precisions for the variants mode. C has no templates, so the
+   driver below handles all four through a precision index: elements
+   are accessed as double complex via get_element/set_element and
+   only the gemm call itself is precision specific. */
+enum { PREC_S, PREC_D, PREC_C, PREC_Z, N_PRECISIONS };
+static const char precisionNames[N_PRECISIONS] = { 's', 'd', 'c', 'z' };
+static const size_t precisionElementSize[N_PRECISIONS] = { sizeof(float), sizeof(double), sizeof(float complex), sizeof(double complex) };
+
+static double complex get_element(int prec, const void* X, size_t idx) {
+  switch(prec) {
+  case PREC_S: return ((const float*)X)[idx];
+  case PREC_D: return ((const double*)X)[idx];
+  case PREC_C: return ((const float complex*)X)[idx];
+  default:     return ((const double complex*)X)[idx];
+  }
+}
+
+static void set_element(int prec, void* X, size_t idx, double complex value) {
+  switch(prec) {
+  case PREC_S: ((float*)X)[idx] = creal(value); break;
+  case PREC_D: ((double*)X)[idx] = creal(value); break;
+  case PREC_C: ((float complex*)X)[idx] = value; break;
+  default:     ((double complex*)X)[idx] = value; break;
+  }
+}
+
+typedef struct {
+  int prec;
+  char transA;
+  char transB;
+  int M, N, K;
+  const void* A;
+  const void* B;
+  void* C;
+} GemmVariantArgs;
+
+/* Computes C = op(A)*op(B), column-major, with the BLAS routine for
+   the precision. */
+static void gemm_variant_func(void* arg) {
+  GemmVariantArgs* g = (GemmVariantArgs*)arg;
+  int lda = g->transA == 'N' ? g->M : g->K;
+  int ldb = g->transB == 'N' ? g->K : g->N;
+  int ldc = g->M;
+  switch(g->prec) {
+  case PREC_S: {
+    float alpha = 1, beta = 0;
+    sgemm_(&g->transA, &g->transB, &g->M, &g->N, &g->K, &alpha, (const float*)g->A, &lda,
+	   (const float*)g->B, &ldb, &beta, (float*)g->C, &ldc);
+    break;
+  }
+  case PREC_D: {
+    double alpha = 1, beta = 0;
+    dgemm_(&g->transA, &g->transB, &g->M, &g->N, &g->K, &alpha, (const double*)g->A, &lda,
+	   (const double*)g->B, &ldb, &beta, (double*)g->C, &ldc);
+    break;
+  }
+  case PREC_C: {
+    float complex alpha = 1, beta = 0;
+    cgemm_(&g->transA, &g->transB, &g->M, &g->N, &g->K, &alpha, (const float complex*)g->A, &lda,
+	   (const float complex*)g->B, &ldb, &beta, (float complex*)g->C, &ldc);
+    break;
+  }
+  default: {
+    double complex alpha = 1, beta = 0;
+    zgemm_(&g->transA, &g->transB, &g->M, &g->N, &g->K, &alpha, (const double complex*)g->A, &lda,
+	   (const double complex*)g->B, &ldb, &beta, (double complex*)g->C, &ldc);
+    break;
+  }
+  }
+}
+
+/* Checks nChecks random elements of C against a double precision
+   computation from A and B. Returns the largest error relative to
+   sum_k |op(A)_ik| |op(B)_kj|, which should be at most about K times
+   the machine epsilon of the precision. */
+static double verify_gemm_variant(const GemmVariantArgs* g, int nChecks) {
+  int lda = g->transA == 'N' ? g->M : g->K;
+  int ldb = g->transB == 'N' ? g->K : g->N;
+  double maxRelErr = 0;
+  int check;
+  for(check = 0; check < nChecks; check++) {
+    int i = rand() % g->M;
+    int j = rand() % g->N;
+    double complex sum = 0;
+    double bound = 0;
+    int k;
+    for(k = 0; k < g->K; k++) {
+      double complex a = get_element(g->prec, g->A, g->transA == 'N' ? i + (size_t)k*lda : k + (size_t)i*lda);
+      double complex b = get_element(g->prec, g->B, g->transB == 'N' ? k + (size_t)j*ldb : j + (size_t)k*ldb);
+      sum += a*b;
+      bound += cabs(a)*cabs(b);
+    }
+    double err = cabs(get_element(g->prec, g->C, i + (size_t)j*g->M) - sum);
+    if(bound > 0 && err / bound > maxRelErr)
+      maxRelErr = err / bound;
+  }
+  return maxRelErr;
+}
+
+/* Variants mode: for each shape MxNxK, time s/d/c/z gemm with all
+   four transpose combinations and verify each result. */
+static int do_gemm_variants(const char* shapeList, int nRepetitions) {
+  char* shapeListCopy = strdup(shapeList);
+  double* times = (double*)malloc(nRepetitions*sizeof(double));
+  int nErrors = 0;
+  printf("# %4s %6s %6s %7s %7s %7s %12s %10s %12s %6s\n", "prec", "transA", "transB", "M", "N", "K",
+	 "median_s", "GFLOP/s", "max_rel_err", "status");
+  char* shape;
+  for(shape = strtok(shapeListCopy, ","); shape; shape = strtok(NULL, ",")) {
+    int M, N, K;
+    if(sscanf(shape, "%dx%dx%d", &M, &N, &K) != 3 || M <= 0 || N <= 0 || K <= 0) {
+      printf("Error: shape '%s' not on the form MxNxK.\n", shape);
+      free(times);
+      free(shapeListCopy);
+      return -1;
+    }
+    int prec;
+    for(prec = 0; prec < N_PRECISIONS; prec++) {
+      size_t elementSize = precisionElementSize[prec];
+      int isComplex = prec == PREC_C || prec == PREC_Z;
+      void* A = malloc((size_t)M*K*elementSize);
+      void* B = malloc((size_t)K*N*elementSize);
+      void* C = malloc((size_t)M*N*elementSize);
+      size_t idx;
+      for(idx = 0; idx < (size_t)M*K; idx++)
+	set_element(prec, A, idx, (double)rand() / RAND_MAX + (isComplex ? I * ((double)rand() / RAND_MAX) : 0));
+      for(idx = 0; idx < (size_t)K*N; idx++)
+	set_element(prec, B, idx, (double)rand() / RAND_MAX + (isComplex ? I * ((double)rand() / RAND_MAX) : 0));
+      // A complex multiply-add is 8 real flops
+      double flops = (isComplex ? 8.0 : 2.0) * M * N * K;
+      double eps = (prec == PREC_S || prec == PREC_C) ? FLT_EPSILON : DBL_EPSILON;
+      int t;
+      for(t = 0; t < 4; t++) {
+	GemmVariantArgs args = { prec, (t & 2) ? 'T' : 'N', (t & 1) ? 'T' : 'N', M, N, K, A, B, C };
+	bench_repeat(gemm_variant_func, &args, 1, nRepetitions, times);
+	BenchStats stats;
+	bench_compute_stats(times, nRepetitions, &stats);
+	double maxRelErr = verify_gemm_variant(&args, 20);
+	int ok = maxRelErr <= 4 * K * eps;
+	if(!ok)
+	  nErrors++;
+	printf("  %4c %6c %6c %7d %7d %7d %12.6f %10.3f %12.3g %6s\n", precisionNames[prec], args.transA, args.transB,
+	       M, N, K, stats.median, flops / stats.median / 1e9, maxRelErr, ok ? "OK" : "FAILED");
+	char benchmark[16], params[128];
+	snprintf(benchmark, sizeof(benchmark), "%cgemm_%c%c", precisionNames[prec], args.transA, args.transB);
+	snprintf(params, sizeof(params), "M=%d N=%d K=%d", M, N, K);
+	bench_write_result("blas_mmul_test", benchmark, params, &stats);
+      }
+      free(A);
+      free(B);
+      free(C);
+    }
+  }
+  free(times);
+  free(shapeListCopy);
+  if(nErrors != 0) {
+    printf("Error: %d gemm variants gave wrong results.\n", nErrors);
+    return -1;
+  }
+  printf("blas_mmul_test variants finished OK.\n");
+  return 0;
+}
+
 int main(int argc, char *argv[])
 {
+  if(argc >= 2 && strcmp(argv[1], "variants") == 0) {
+    if(argc != 4) {
+      printf("Variants mode usage: variants M1xN1xK1,M2xN2xK2,... nRepetitions\n");
+      return -1;
+    }
+    int nRepetitions = atoi(argv[3]);
+    if(nRepetitions <= 0) {
+      printf("Error: nRepetitions must be positive.\n");
+      return -1;
+    }
+    return do_gemm_variants(argv[2], nRepetitions);
+  }
+  if(argc >= 2 && strcmp(argv[1], "sweep") == 0) {
+    if(argc != 6) {
+      printf("Sweep mode usage: sweep lib1.so,lib2.so,... n1,n2,... threads1,threads2,... nRepetitions\n");
+      return -1;
+    }
+    int nRepetitions = atoi(argv[5]);
+    if(nRepetitions <= 0) {
+      printf("Error: nRepetitions must be positive.\n");
+      return -1;
+    }
+    return do_backend_sweep(argv[2], argv[3], argv[4], nRepetitions);
+  }
   int n = 500;
   if(argc >= 2)
     n = atoi(argv[1]);
   int do_naive_mmul_comparison = 1;
   if(argc >= 3)
     do_naive_mmul_comparison = atoi(argv[2]);
-  printf("blas_mmul_test start, matrix size n = %6d, do_naive_mmul_comparison = %d.\n", n, do_naive_mmul_comparison);
+  int nRepetitions = 1;
+  if(argc >= 4)
+    nRepetitions = atoi(argv[3]);
+  if(nRepetitions <= 0) {
+    printf("Error: nRepetitions must be positive.\n");
+    return -1;
+  }
+  printf("blas_mmul_test start, matrix size n = %6d, do_naive_mmul_comparison = %d, nRepetitions = %d.\n",
+	 n, do_naive_mmul_comparison, nRepetitions);
+  double* times = (double*)malloc(nRepetitions*sizeof(double));
+  BenchStats stats;
+  char params[64];
+  snprintf(params, sizeof(params), "n=%d", n);
   // Generate matrices A and B filled with random numbers.
   double* A = (double*)malloc(n*n*sizeof(double));
   double* B = (double*)malloc(n*n*sizeof(double));
@@ -109,10 +589,11 @@ int main(int argc, char *argv[])
   // Compute matrix C = A*B using naive implementation.
   double* C = (double*)malloc(n*n*sizeof(double));
   if(do_naive_mmul_comparison == 1) {
-    double seconds_start = get_wall_seconds();
+    double seconds_start = bench_seconds();
     do_naive_mmul(C, A, B, n);
-    double secondsTaken_naive_mmul = get_wall_seconds() - seconds_start;
-    printf("do_naive_mmul took   %6.3f wall seconds.\n", secondsTaken_naive_mmul);
+    double secondsTaken_naive_mmul = bench_seconds() - seconds_start;
+    printf("do_naive_mmul took   %6.3f wall seconds, %8.3f GFLOP/s.\n", secondsTaken_naive_mmul, get_gflops(n, secondsTaken_naive_mmul));
+    write_single_result("naive", n, secondsTaken_naive_mmul);
     verify_mmul_result(A, B, C, n);
   }
 
@@ -120,12 +601,13 @@ int main(int argc, char *argv[])
   double alpha = 1;
   double beta = 0;
   double* C2 = (double*)malloc(n*n*sizeof(double));
-  double seconds_start_BLAS_gemm_1 = get_wall_seconds();
+  double seconds_start_BLAS_gemm_1 = bench_seconds();
   dgemm_("T", "T", &n, &n, &n, &alpha,
 	 &A[0], &n, &B[0], &n,
 	 &beta, &C2[0], &n);
-  double secondsTaken_BLAS_gemm_1 = get_wall_seconds() - seconds_start_BLAS_gemm_1;
-  printf("BLAS gemm call took   %6.3f wall seconds.\n", secondsTaken_BLAS_gemm_1);
+  double secondsTaken_BLAS_gemm_1 = bench_seconds() - seconds_start_BLAS_gemm_1;
+  printf("BLAS gemm call took   %6.3f wall seconds, %8.3f GFLOP/s.\n", secondsTaken_BLAS_gemm_1, get_gflops(n, secondsTaken_BLAS_gemm_1));
+  write_single_result("blas_first_call", n, secondsTaken_BLAS_gemm_1);
   double diff1 = 0;
   if(do_naive_mmul_comparison == 1) {
     // Check that results are equal.
@@ -136,12 +618,14 @@ int main(int argc, char *argv[])
 
   // Now do the same computation by again calling the BLAS gemm routine.
   double* C3 = (double*)malloc(n*n*sizeof(double));
-  double seconds_start_BLAS_gemm_2 = get_wall_seconds();
-  dgemm_("T", "T", &n, &n, &n, &alpha,
-	 &A[0], &n, &B[0], &n,
-	 &beta, &C3[0], &n);
-  double secondsTaken_BLAS_gemm_2 = get_wall_seconds() - seconds_start_BLAS_gemm_2;
-  printf("BLAS gemm call took   %6.3f wall seconds.\n", secondsTaken_BLAS_gemm_2);
+  GemmArgs gemmArgs = { n, A, B, C3, 0, 0 };
+  bench_repeat(gemm_func, &gemmArgs, 0, nRepetitions, times);
+  bench_compute_stats(times, nRepetitions, &stats);
+  double secondsTaken_BLAS_gemm_2 = stats.median;
+  printf("BLAS gemm call took   %6.3f wall seconds, %8.3f GFLOP/s.\n", secondsTaken_BLAS_gemm_2, get_gflops(n, secondsTaken_BLAS_gemm_2));
+  if(nRepetitions > 1)
+    bench_print_stats("BLAS gemm", &stats, 1, "s");
+  bench_write_result("blas_mmul_test", "blas", params, &stats);
   double diff2 = 0;
   if(do_naive_mmul_comparison == 1) {
     // Check that results are equal.
@@ -150,13 +634,35 @@ int main(int argc, char *argv[])
   }
   verify_mmul_result(A, B, C3, n);
 
+  // Now do the same computation using the built-in SIMD kernel.
+  double* C4 = (double*)malloc(n*n*sizeof(double));
+  GemmArgs simdArgs = { n, A, B, C4, 1, 0 };
+  bench_repeat(gemm_func, &simdArgs, 0, nRepetitions, times);
+  if(simdArgs.failed)
+    return -1;
+  bench_compute_stats(times, nRepetitions, &stats);
+  double secondsTaken_simd_gemm = stats.median;
+  printf("simd_dgemm (%s kernel) call took   %6.3f wall seconds, %8.3f GFLOP/s.\n",
+	 simd_dgemm_kernel_name(), secondsTaken_simd_gemm, get_gflops(n, secondsTaken_simd_gemm));
+  if(nRepetitions > 1)
+    bench_print_stats("simd_dgemm", &stats, 1, "s");
+  bench_write_result("blas_mmul_test", "simd_dgemm", params, &stats);
+  // Check against the BLAS result.
+  double diff3 = compare_matrices(C2, C4, n);
+  printf("Max abs diff (elementwise) between BLAS gemm and simd_dgemm results: %6.3g\n", (double)diff3);
+  verify_mmul_result(A, B, C4, n);
+
+  double tol = 1e-4;
   if(do_naive_mmul_comparison == 1) {
-    double tol = 1e-4;
     if(diff1 > tol || diff2 > tol) {
       printf("Error: too large diff between naive mmul and BLAS gemm results.\n");
       return -1;
     }
   }
+  if(diff3 > tol) {
+    printf("Error: too large diff between BLAS gemm and simd_dgemm results.\n");
+    return -1;
+  }
   
   printf("blas_mmul_test finished OK.\n");
   return 0;
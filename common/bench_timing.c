@@ -0,0 +1,156 @@
+/* Timing and statistics, see bench_timing.h. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "bench_timing.h"
+
+double bench_seconds(void) {
+  struct timespec ts;
+#ifdef CLOCK_MONOTONIC_RAW
+  if(clock_gettime(CLOCK_MONOTONIC_RAW, &ts) != 0)
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+static int compare_doubles(const void* p1, const void* p2) {
+  double x1 = *(const double*)p1;
+  double x2 = *(const double*)p2;
+  if(x1 < x2)
+    return -1;
+  if(x1 > x2)
+    return 1;
+  return 0;
+}
+
+double bench_percentile(const double* sortedList, int n, double percentile) {
+  int idx = (int)((percentile / 100) * n + 0.999999) - 1;
+  if(idx < 0)
+    idx = 0;
+  if(idx >= n)
+    idx = n-1;
+  return sortedList[idx];
+}
+
+void bench_compute_stats(const double* samples, int n, BenchStats* stats) {
+  memset(stats, 0, sizeof(BenchStats));
+  stats->n = n;
+  if(n <= 0)
+    return;
+  double* sorted = (double*)malloc(n*sizeof(double));
+  memcpy(sorted, samples, n*sizeof(double));
+  qsort(sorted, n, sizeof(double), compare_doubles);
+  double sum = 0;
+  int i;
+  for(i = 0; i < n; i++)
+    sum += sorted[i];
+  stats->mean = sum / n;
+  double sumSq = 0;
+  for(i = 0; i < n; i++)
+    sumSq += (sorted[i] - stats->mean) * (sorted[i] - stats->mean);
+  stats->stddev = n > 1 ? sqrt(sumSq / (n-1)) : 0;
+  stats->min = sorted[0];
+  stats->max = sorted[n-1];
+  if(n % 2 == 1)
+    stats->median = sorted[n/2];
+  else
+    stats->median = 0.5 * (sorted[n/2-1] + sorted[n/2]);
+  stats->p90 = bench_percentile(sorted, n, 90);
+  stats->p99 = bench_percentile(sorted, n, 99);
+  /* Distribution-free interval: the ranks n/2 -+ 1.96*sqrt(n)/2
+     contain the median with about 95% probability. For few samples
+     this is simply the whole range. */
+  double halfWidth = 1.96 * sqrt((double)n) / 2;
+  int lowIdx = (int)floor(n / 2.0 - halfWidth);
+  int highIdx = (int)ceil(n / 2.0 + halfWidth) - 1;
+  if(lowIdx < 0)
+    lowIdx = 0;
+  if(highIdx > n-1)
+    highIdx = n-1;
+  stats->ciLow = sorted[lowIdx];
+  stats->ciHigh = sorted[highIdx];
+  free(sorted);
+}
+
+void bench_repeat(void (*func)(void*), void* arg, int nWarmup, int nRepetitions, double* samples) {
+  int i;
+  for(i = 0; i < nWarmup; i++)
+    func(arg);
+  for(i = 0; i < nRepetitions; i++) {
+    double startTime = bench_seconds();
+    func(arg);
+    samples[i] = bench_seconds() - startTime;
+  }
+}
+
+void bench_print_stats(const char* label, const BenchStats* stats, double unitFactor, const char* unitName) {
+  printf("%s: median %.3f %s (95%% CI %.3f - %.3f), min %.3f, max %.3f, n = %d\n", label,
+	 stats->median*unitFactor, unitName, stats->ciLow*unitFactor, stats->ciHigh*unitFactor,
+	 stats->min*unitFactor, stats->max*unitFactor, stats->n);
+}
+
+/* Writes s as a quoted string, for JSON if json is 1, else for CSV. */
+static void write_quoted(FILE* f, const char* s, int json) {
+  fputc('"', f);
+  for(; *s; s++) {
+    if(*s == '"')
+      fputs(json ? "\\\"" : "\"\"", f);
+    else if(json && *s == '\\')
+      fputs("\\\\", f);
+    else
+      fputc(*s, f);
+  }
+  fputc('"', f);
+}
+
+int bench_write_result(const char* program, const char* benchmark, const char* params, const BenchStats* stats) {
+  const char* fileName = getenv("BENCH_RESULTS");
+  if(!fileName || fileName[0] == '\0')
+    return 0;
+  size_t len = strlen(fileName);
+  int json = !(len >= 4 && strcmp(fileName+len-4, ".csv") == 0);
+  FILE* f = fopen(fileName, "a");
+  if(!f) {
+    printf("Warning: could not open BENCH_RESULTS file '%s'.\n", fileName);
+    return -1;
+  }
+  char hostName[256] = "unknown";
+  gethostname(hostName, sizeof(hostName)-1);
+  // Write a header line when starting a new CSV file
+  fseek(f, 0, SEEK_END);
+  if(!json && ftell(f) == 0)
+    fprintf(f, "host,program,benchmark,params,n,median_s,ci_low_s,ci_high_s,min_s,max_s,mean_s,stddev_s,p90_s,p99_s\n");
+  if(json) {
+    fprintf(f, "{\"host\": ");
+    write_quoted(f, hostName, 1);
+    fprintf(f, ", \"program\": ");
+    write_quoted(f, program, 1);
+    fprintf(f, ", \"benchmark\": ");
+    write_quoted(f, benchmark, 1);
+    fprintf(f, ", \"params\": ");
+    write_quoted(f, params, 1);
+    fprintf(f, ", \"n\": %d, \"median_s\": %.9g, \"ci_low_s\": %.9g, \"ci_high_s\": %.9g, \"min_s\": %.9g, \"max_s\": %.9g"
+	    ", \"mean_s\": %.9g, \"stddev_s\": %.9g, \"p90_s\": %.9g, \"p99_s\": %.9g}\n",
+	    stats->n, stats->median, stats->ciLow, stats->ciHigh, stats->min, stats->max,
+	    stats->mean, stats->stddev, stats->p90, stats->p99);
+  }
+  else {
+    write_quoted(f, hostName, 0);
+    fputc(',', f);
+    write_quoted(f, program, 0);
+    fputc(',', f);
+    write_quoted(f, benchmark, 0);
+    fputc(',', f);
+    write_quoted(f, params, 0);
+    fprintf(f, ",%d,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n",
+	    stats->n, stats->median, stats->ciLow, stats->ciHigh, stats->min, stats->max,
+	    stats->mean, stats->stddev, stats->p90, stats->p99);
+  }
+  fclose(f);
+  return 0;
+}
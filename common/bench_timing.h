@@ -0,0 +1,67 @@
+/* Timing and statistics shared by the benchmark programs.
+
+   bench_seconds() reads CLOCK_MONOTONIC_RAW, which has nanosecond
+   resolution and is not affected by NTP adjustments, so short and
+   long intervals can both be timed with it. bench_repeat() runs a
+   function a number of times after some warm-up calls and records the
+   time of each call, and bench_compute_stats() gives outlier-robust
+   statistics for such samples.
+
+   Results can also be written to a file for automatic comparison
+   between systems: if the environment variable BENCH_RESULTS is set
+   to a file name, bench_write_result() appends one record per call
+   to that file, as CSV if the name ends with .csv and otherwise as
+   JSON (one object per line). Each record contains the host name, so
+   files from several clusters can simply be concatenated.
+*/
+
+#ifndef BENCH_TIMING_HEADER
+#define BENCH_TIMING_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Monotonic wall time in seconds. */
+double bench_seconds(void);
+
+typedef struct {
+  int n;
+  double min;
+  double max;
+  double mean;
+  double stddev;
+  double median;
+  double p90;
+  double p99;
+  // 95% confidence interval for the median, from order statistics
+  double ciLow;
+  double ciHigh;
+} BenchStats;
+
+/* Returns the given percentile (nearest-rank method) of the n values
+   in the sorted list. */
+double bench_percentile(const double* sortedList, int n, double percentile);
+
+/* Computes statistics of n samples. The samples are not modified. */
+void bench_compute_stats(const double* samples, int n, BenchStats* stats);
+
+/* Calls func(arg) nWarmup times without timing, then nRepetitions
+   times storing the time in seconds of each call in samples. */
+void bench_repeat(void (*func)(void*), void* arg, int nWarmup, int nRepetitions, double* samples);
+
+/* Prints median, min, max and the confidence interval on one line,
+   scaled by unitFactor (e.g. 1e6 for microseconds). */
+void bench_print_stats(const char* label, const BenchStats* stats, double unitFactor, const char* unitName);
+
+/* Appends a result record to the BENCH_RESULTS file, if set. program
+   and benchmark identify the measurement and params is a free-form
+   string like "n=1000 threads=4". The statistics are for times in
+   seconds. Returns 0 on success or if BENCH_RESULTS is not set. */
+int bench_write_result(const char* program, const char* benchmark, const char* params, const BenchStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,120 @@
+/* CPU topology detection and thread pinning, see cpu_topology.h. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include "cpu_topology.h"
+
+static int read_topology_value(int cpu, const char* name, int defaultValue) {
+  char fileName[256];
+  sprintf(fileName, "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+  FILE* f = fopen(fileName, "r");
+  if(!f)
+    return defaultValue;
+  int value;
+  if(fscanf(f, "%d", &value) != 1)
+    value = defaultValue;
+  fclose(f);
+  return value;
+}
+
+int get_cpu_topology(CpuInfo* cpus, int maxCpus) {
+  cpu_set_t mask;
+  if(sched_getaffinity(0, sizeof(mask), &mask) != 0)
+    return 0;
+  int nCpus = 0;
+  int cpu;
+  for(cpu = 0; cpu < CPU_SETSIZE && nCpus < maxCpus; cpu++) {
+    if(!CPU_ISSET(cpu, &mask))
+      continue;
+    cpus[nCpus].cpu = cpu;
+    cpus[nCpus].socket = read_topology_value(cpu, "physical_package_id", 0);
+    cpus[nCpus].core = read_topology_value(cpu, "core_id", cpu);
+    nCpus++;
+  }
+  int i, j;
+  for(i = 0; i < nCpus; i++) {
+    cpus[i].smtIdx = 0;
+    for(j = 0; j < i; j++)
+      if(cpus[j].socket == cpus[i].socket && cpus[j].core == cpus[i].core)
+	cpus[i].smtIdx++;
+  }
+  for(i = 0; i < nCpus; i++) {
+    // Count distinct cores with lower core_id on the same socket
+    cpus[i].coreIdx = 0;
+    for(j = 0; j < nCpus; j++)
+      if(cpus[j].socket == cpus[i].socket && cpus[j].core < cpus[i].core && cpus[j].smtIdx == 0)
+	cpus[i].coreIdx++;
+  }
+  return nCpus;
+}
+
+int count_sockets(const CpuInfo* cpus, int nCpus) {
+  int nSockets = 0, i, j;
+  for(i = 0; i < nCpus; i++) {
+    // Counted at the first CPU of each socket
+    for(j = 0; j < i; j++)
+      if(cpus[j].socket == cpus[i].socket)
+	break;
+    if(j == i)
+      nSockets++;
+  }
+  return nSockets;
+}
+
+void print_cpu_topology(const CpuInfo* cpus, int nCpus) {
+  int nSockets = count_sockets(cpus, nCpus), nCores = 0, i;
+  for(i = 0; i < nCpus; i++) {
+    if(cpus[i].smtIdx == 0)
+      nCores++;
+  }
+  printf("Detected topology: %d CPUs, %d physical cores, %d socket(s), %d SMT thread(s) per core\n",
+	 nCpus, nCores, nSockets, nCores > 0 ? nCpus / nCores : 0);
+  printf("  cpu socket core smt\n");
+  for(i = 0; i < nCpus; i++)
+    printf("  %3d %6d %4d %3d\n", cpus[i].cpu, cpus[i].socket, cpus[i].core, cpus[i].smtIdx);
+}
+
+static int compare_cpus(const void* p1, const void* p2) {
+  const CpuInfo* c1 = (const CpuInfo*)p1;
+  const CpuInfo* c2 = (const CpuInfo*)p2;
+  int k;
+  for(k = 0; k < 3; k++) {
+    if(c1->sortKey[k] != c2->sortKey[k])
+      return c1->sortKey[k] < c2->sortKey[k] ? -1 : 1;
+  }
+  return c1->cpu - c2->cpu;
+}
+
+int order_cpus(CpuInfo* cpus, int nCpus, const char* policy) {
+  int i;
+  for(i = 0; i < nCpus; i++) {
+    int* key = cpus[i].sortKey;
+    if(strcmp(policy, "none") == 0 || strcmp(policy, "compact") == 0) {
+      key[0] = cpus[i].cpu; key[1] = 0; key[2] = 0;
+    }
+    else if(strcmp(policy, "scatter") == 0) {
+      key[0] = cpus[i].smtIdx; key[1] = cpus[i].coreIdx; key[2] = cpus[i].socket;
+    }
+    else if(strcmp(policy, "cores") == 0) {
+      key[0] = cpus[i].smtIdx; key[1] = cpus[i].socket; key[2] = cpus[i].core;
+    }
+    else if(strcmp(policy, "smt") == 0) {
+      key[0] = cpus[i].socket; key[1] = cpus[i].core; key[2] = cpus[i].smtIdx;
+    }
+    else
+      return 0;
+  }
+  qsort(cpus, nCpus, sizeof(CpuInfo), compare_cpus);
+  return 1;
+}
+
+int pin_current_thread(int cpu) {
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu, &mask);
+  return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+}
@@ -0,0 +1,54 @@
+/* CPU topology detection and thread pinning shared by the threaded
+   benchmark programs. The topology (socket, physical core and SMT
+   sibling of each CPU) is read from /sys/devices/system/cpu, so this
+   is Linux-specific.
+
+   Affinity policies understood by order_cpus:
+
+     none     same order as compact, meant for unpinned runs
+     compact  CPUs in order of logical CPU number
+     scatter  round-robin over sockets, one thread per physical core
+              before using SMT siblings
+     cores    one thread per physical core (socket by socket) before
+              using SMT siblings
+     smt      all SMT siblings of a physical core before the next core
+*/
+
+#ifndef CPU_TOPOLOGY_HEADER
+#define CPU_TOPOLOGY_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  int cpu;
+  int socket;
+  int core;
+  int smtIdx;  // index among the SMT siblings of the physical core
+  int coreIdx; // index of the physical core within its socket
+  int sortKey[3];
+} CpuInfo;
+
+/* Gets socket and core for each CPU that this process may run on.
+   Returns the number of CPUs, 0 on failure. */
+int get_cpu_topology(CpuInfo* cpus, int maxCpus);
+
+void print_cpu_topology(const CpuInfo* cpus, int nCpus);
+
+/* Number of distinct sockets among the CPUs, socket ids need not be
+   contiguous or start at 0. */
+int count_sockets(const CpuInfo* cpus, int nCpus);
+
+/* Sorts the CPUs in the order they should be used for the given
+   policy. Returns 0 if the policy is unknown. */
+int order_cpus(CpuInfo* cpus, int nCpus, const char* policy);
+
+/* Pins the calling thread to the given CPU. Returns 0 on success. */
+int pin_current_thread(int cpu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,125 @@
+/* Clock frequency measurement, see cycle_freq.h. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "cycle_freq.h"
+#include "bench_timing.h"
+
+// Number of dependent additions in one loop iteration
+#define CHAIN_BLOCK 100
+#define STR_(x) #x
+#define STR(x) STR_(x)
+
+static unsigned long long read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int lo, hi;
+  __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((unsigned long long)hi << 32) | lo;
+#elif defined(__aarch64__)
+  unsigned long long value;
+  __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(value));
+  return value;
+#else
+  return 0;
+#endif
+}
+
+/* Opens a counter of user-space core cycles for the calling thread.
+   Returns -1 if not allowed or not supported. */
+static int open_cycle_counter() {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_CPU_CYCLES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void run_chain_loops(long int nLoops) {
+  long int x = 0;
+  // Adding a register rather than an immediate, since some cores can
+  // fold additions of small immediates at register renaming
+  long int one = 1;
+  __asm__ volatile("" : "+r"(one));
+  long int i;
+  for(i = 0; i < nLoops; i++) {
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ volatile(".rept " STR(CHAIN_BLOCK) "\n\tadd %1, %0\n\t.endr" : "+r"(x) : "r"(one));
+#elif defined(__aarch64__)
+    __asm__ volatile(".rept " STR(CHAIN_BLOCK) "\n\tadd %0, %0, %1\n\t.endr" : "+r"(x) : "r"(one));
+#else
+    // The empty asm makes the compiler keep every addition
+    int k;
+    for(k = 0; k < CHAIN_BLOCK; k++) {
+      x += one;
+      __asm__ volatile("" : "+r"(x));
+    }
+#endif
+  }
+}
+
+void cycle_freq_run_chain(long int nOps, CycleFreqResult* result) {
+  long int nLoops = nOps / CHAIN_BLOCK;
+  int fd = open_cycle_counter();
+  if(fd >= 0) {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  double startTime = bench_seconds();
+  unsigned long long startTsc = read_tsc();
+  run_chain_loops(nLoops);
+  unsigned long long endTsc = read_tsc();
+  double endTime = bench_seconds();
+  result->perfCycles = 0;
+  if(fd >= 0) {
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    long long count;
+    if(read(fd, &count, sizeof(count)) == sizeof(count))
+      result->perfCycles = count;
+    close(fd);
+  }
+  result->seconds = endTime - startTime;
+  result->nChainOps = (double)nLoops * CHAIN_BLOCK;
+  result->tscTicks = endTsc - startTsc;
+}
+
+double cycle_freq_chain_ghz(const CycleFreqResult* result) {
+  return result->seconds > 0 ? result->nChainOps / result->seconds / 1e9 : 0;
+}
+
+double cycle_freq_tsc_ghz(const CycleFreqResult* result) {
+  return result->seconds > 0 ? result->tscTicks / result->seconds / 1e9 : 0;
+}
+
+double cycle_freq_perf_ghz(const CycleFreqResult* result) {
+  return result->seconds > 0 ? result->perfCycles / result->seconds / 1e9 : 0;
+}
+
+double cycle_freq_core_ghz(const CycleFreqResult* result) {
+  if(result->perfCycles > 0)
+    return cycle_freq_perf_ghz(result);
+  return cycle_freq_chain_ghz(result);
+}
+
+void cycle_freq_print(const CycleFreqResult* result, const char* label) {
+  double tscFreq = cycle_freq_tsc_ghz(result);
+  printf("--> addition chain: %4.2f GHz (%s)\n", cycle_freq_chain_ghz(result), label);
+  if(result->perfCycles > 0)
+    printf("--> perf_event_open core cycles: %4.2f GHz (%s)\n", cycle_freq_perf_ghz(result), label);
+  else
+    printf("--> perf_event_open core cycles: not available (%s)\n", label);
+  if(tscFreq > 0) {
+    printf("--> TSC frequency: %4.2f GHz (%s)\n", tscFreq, label);
+    printf("--> core/TSC frequency ratio: %5.3f (%s)\n", cycle_freq_core_ghz(result) / tscFreq, label);
+  }
+  else
+    printf("--> TSC frequency: not available (%s)\n", label);
+}
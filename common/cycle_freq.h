@@ -0,0 +1,53 @@
+/* Clock frequency measurement shared by the clock frequency test
+   programs. The work done is a chain of dependent integer additions
+   written in inline assembly, so that the compiler cannot optimize
+   it away or change it, and the programs can be compiled with the
+   same optimization flags as production code. Each addition depends
+   on the previous one, so on current processors the chain runs at
+   one addition per core clock cycle. A register is added rather than
+   an immediate value, since some newer cores can eliminate chains of
+   immediate additions at register renaming.
+
+   During the run the time stamp counter (TSC, or the generic timer
+   on ARM) and, when the kernel allows it, the core cycle counter from
+   perf_event_open are also read. This gives three numbers: the TSC
+   frequency, the actual core frequency and the ratio between them,
+   which shows the effect of turbo or power capping.
+*/
+
+#ifndef CYCLE_FREQ_HEADER
+#define CYCLE_FREQ_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  double seconds;    // wall time of the run
+  double nChainOps;  // number of dependent additions done
+  double tscTicks;   // time stamp counter ticks, 0 if no counter
+  double perfCycles; // core cycles from perf_event_open, 0 if not available
+} CycleFreqResult;
+
+/* Runs a chain of (about) nOps dependent additions in the calling
+   thread and measures it. */
+void cycle_freq_run_chain(long int nOps, CycleFreqResult* result);
+
+/* Frequencies in GHz computed from a result, 0 if not available. */
+double cycle_freq_chain_ghz(const CycleFreqResult* result);
+double cycle_freq_tsc_ghz(const CycleFreqResult* result);
+double cycle_freq_perf_ghz(const CycleFreqResult* result);
+
+/* Best estimate of the core frequency: from perf_event_open cycles
+   when available, otherwise from the addition chain. */
+double cycle_freq_core_ghz(const CycleFreqResult* result);
+
+/* Prints frequencies and the core/TSC ratio, label is added to each
+   line. */
+void cycle_freq_print(const CycleFreqResult* result, const char* label);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
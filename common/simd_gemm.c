@@ -0,0 +1,271 @@
+/* Cache-blocked, packed-panel dgemm with register-tiled SIMD
+   micro-kernels, see simd_gemm.h.
+
+   Loop structure (as in BLIS/GotoBLAS): the k dimension is split in
+   blocks of KC and n in blocks of NC. For each such block of op(B), a
+   KC x NC panel is packed into NR-column slivers. Then for each MC x KC
+   block of op(A), packed into MR-row slivers, the micro-kernel
+   computes all MR x NR tiles of C, keeping the tile in registers over
+   the whole KC loop.
+*/
+
+#include "simd_gemm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+
+/* Micro-kernel: C[0:MR,0:NR] += a * b where a is a packed MR x kc
+   sliver and b a packed kc x NR sliver. C is column-major with
+   leading dimension ldc. */
+typedef void (*micro_kernel_func)(int kc, const double* a, const double* b, double* C, int ldc);
+
+typedef struct {
+  const char* name;
+  int MR, NR; /* register tile size */
+  int MC, KC, NC; /* cache blocking */
+  micro_kernel_func kernel;
+} kernel_info;
+
+#define MAX_MR 16
+#define MAX_NR 12
+
+/* ---------- Generic C micro-kernel, MR x NR = 4 x 4 ---------- */
+
+static void micro_kernel_generic(int kc, const double* a, const double* b, double* C, int ldc) {
+  double c[4][4] = {{0}};
+  int p, i, j;
+  for(p = 0; p < kc; p++) {
+    for(j = 0; j < 4; j++)
+      for(i = 0; i < 4; i++)
+	c[j][i] += a[i] * b[j];
+    a += 4;
+    b += 4;
+  }
+  for(j = 0; j < 4; j++)
+    for(i = 0; i < 4; i++)
+      C[j*ldc+i] += c[j][i];
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/* ---------- AVX2/FMA micro-kernel, MR x NR = 8 x 6 ----------
+   12 accumulator registers, 2 for the a sliver and 1 broadcast. */
+
+#define AVX2_STEP(j)						\
+  bj = _mm256_broadcast_sd(b+j);				\
+  c##j##0 = _mm256_fmadd_pd(a0, bj, c##j##0);			\
+  c##j##1 = _mm256_fmadd_pd(a1, bj, c##j##1);
+#define AVX2_STORE(j)							\
+  _mm256_storeu_pd(C+j*ldc,   _mm256_add_pd(_mm256_loadu_pd(C+j*ldc),   c##j##0)); \
+  _mm256_storeu_pd(C+j*ldc+4, _mm256_add_pd(_mm256_loadu_pd(C+j*ldc+4), c##j##1));
+
+__attribute__((target("avx2,fma")))
+static void micro_kernel_avx2(int kc, const double* a, const double* b, double* C, int ldc) {
+  __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+  __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+  __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+  __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+  __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+  __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+  __m256d a0, a1, bj;
+  int p;
+  for(p = 0; p < kc; p++) {
+    a0 = _mm256_load_pd(a);
+    a1 = _mm256_load_pd(a+4);
+    AVX2_STEP(0) AVX2_STEP(1) AVX2_STEP(2)
+    AVX2_STEP(3) AVX2_STEP(4) AVX2_STEP(5)
+    a += 8;
+    b += 6;
+  }
+  AVX2_STORE(0) AVX2_STORE(1) AVX2_STORE(2)
+  AVX2_STORE(3) AVX2_STORE(4) AVX2_STORE(5)
+}
+
+/* ---------- AVX-512 micro-kernel, MR x NR = 16 x 12 ----------
+   24 accumulator registers, 2 for the a sliver and 1 broadcast. */
+
+#define AVX512_STEP(j)						\
+  bj = _mm512_set1_pd(b[j]);					\
+  c##j##0 = _mm512_fmadd_pd(a0, bj, c##j##0);			\
+  c##j##1 = _mm512_fmadd_pd(a1, bj, c##j##1);
+#define AVX512_STORE(j)							\
+  _mm512_storeu_pd(C+j*ldc,   _mm512_add_pd(_mm512_loadu_pd(C+j*ldc),   c##j##0)); \
+  _mm512_storeu_pd(C+j*ldc+8, _mm512_add_pd(_mm512_loadu_pd(C+j*ldc+8), c##j##1));
+#define AVX512_ZERO(j) __m512d c##j##0 = _mm512_setzero_pd(), c##j##1 = _mm512_setzero_pd();
+
+__attribute__((target("avx512f")))
+static void micro_kernel_avx512(int kc, const double* a, const double* b, double* C, int ldc) {
+  AVX512_ZERO(0) AVX512_ZERO(1) AVX512_ZERO(2) AVX512_ZERO(3)
+  AVX512_ZERO(4) AVX512_ZERO(5) AVX512_ZERO(6) AVX512_ZERO(7)
+  AVX512_ZERO(8) AVX512_ZERO(9) AVX512_ZERO(10) AVX512_ZERO(11)
+  __m512d a0, a1, bj;
+  int p;
+  for(p = 0; p < kc; p++) {
+    a0 = _mm512_load_pd(a);
+    a1 = _mm512_load_pd(a+8);
+    AVX512_STEP(0) AVX512_STEP(1) AVX512_STEP(2) AVX512_STEP(3)
+    AVX512_STEP(4) AVX512_STEP(5) AVX512_STEP(6) AVX512_STEP(7)
+    AVX512_STEP(8) AVX512_STEP(9) AVX512_STEP(10) AVX512_STEP(11)
+    a += 16;
+    b += 12;
+  }
+  AVX512_STORE(0) AVX512_STORE(1) AVX512_STORE(2) AVX512_STORE(3)
+  AVX512_STORE(4) AVX512_STORE(5) AVX512_STORE(6) AVX512_STORE(7)
+  AVX512_STORE(8) AVX512_STORE(9) AVX512_STORE(10) AVX512_STORE(11)
+}
+
+#endif
+
+static const kernel_info kernel_generic = { "generic",  4,  4,  64, 256, 2048, micro_kernel_generic };
+#if defined(__x86_64__) || defined(__i386__)
+static const kernel_info kernel_avx2    = { "avx2",     8,  6,  96, 256, 3072, micro_kernel_avx2 };
+static const kernel_info kernel_avx512  = { "avx512",  16, 12, 128, 256, 3072, micro_kernel_avx512 };
+#endif
+
+static const kernel_info* select_kernel(void) {
+  static const kernel_info* selected = NULL;
+  if(selected)
+    return selected;
+  const char* forced = getenv("SIMD_GEMM_KERNEL");
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  int has_avx512 = __builtin_cpu_supports("avx512f");
+  int has_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  if(forced && strcmp(forced, "avx512") == 0 && has_avx512)
+    selected = &kernel_avx512;
+  else if(forced && strcmp(forced, "avx2") == 0 && has_avx2)
+    selected = &kernel_avx2;
+  else if(forced && strcmp(forced, "generic") == 0)
+    selected = &kernel_generic;
+  else if(has_avx512)
+    selected = &kernel_avx512;
+  else if(has_avx2)
+    selected = &kernel_avx2;
+  else
+    selected = &kernel_generic;
+#else
+  (void)forced;
+  selected = &kernel_generic;
+#endif
+  return selected;
+}
+
+const char* simd_dgemm_kernel_name(void) {
+  return select_kernel()->name;
+}
+
+/* Packs the mc x kc block of op(A) starting at (i0, p0) into MR-row
+   slivers, zero-padding the last sliver. */
+static void pack_A(const kernel_info* ki, char transA, const double* A, int lda,
+		   int i0, int p0, int mc, int kc, double* buf) {
+  int MR = ki->MR;
+  int ir, p, r;
+  for(ir = 0; ir < mc; ir += MR) {
+    int mr = mc - ir < MR ? mc - ir : MR;
+    for(p = 0; p < kc; p++) {
+      for(r = 0; r < mr; r++) {
+	int i = i0 + ir + r;
+	int pp = p0 + p;
+	buf[r] = transA == 'N' ? A[i + (size_t)pp*lda] : A[pp + (size_t)i*lda];
+      }
+      for(; r < MR; r++)
+	buf[r] = 0;
+      buf += MR;
+    }
+  }
+}
+
+/* Packs the kc x nc block of op(B) starting at (p0, j0) into NR-column
+   slivers, zero-padding the last sliver. */
+static void pack_B(const kernel_info* ki, char transB, const double* B, int ldb,
+		   int p0, int j0, int kc, int nc, double* buf) {
+  int NR = ki->NR;
+  int jr, p, c;
+  for(jr = 0; jr < nc; jr += NR) {
+    int nr = nc - jr < NR ? nc - jr : NR;
+    for(p = 0; p < kc; p++) {
+      for(c = 0; c < nr; c++) {
+	int j = j0 + jr + c;
+	int pp = p0 + p;
+	buf[c] = transB == 'N' ? B[pp + (size_t)j*ldb] : B[j + (size_t)pp*ldb];
+      }
+      for(; c < NR; c++)
+	buf[c] = 0;
+      buf += NR;
+    }
+  }
+}
+
+static void* aligned_alloc_64(size_t bytes) {
+  void* p = NULL;
+  if(posix_memalign(&p, 64, bytes) != 0)
+    return NULL;
+  return p;
+}
+
+int simd_dgemm(char transA, char transB,
+	       int m, int n, int k,
+	       const double* A, int lda,
+	       const double* B, int ldb,
+	       double beta, double* C, int ldc) {
+  const kernel_info* ki = select_kernel();
+  int MR = ki->MR, NR = ki->NR, MC = ki->MC, KC = ki->KC, NC = ki->NC;
+  int i, j;
+  transA = (transA == 't' || transA == 'T' || transA == 'c' || transA == 'C') ? 'T' : 'N';
+  transB = (transB == 't' || transB == 'T' || transB == 'c' || transB == 'C') ? 'T' : 'N';
+  if(m <= 0 || n <= 0)
+    return 0;
+  /* C = beta*C first, then only accumulation is needed below. */
+  if(beta != 1) {
+    for(j = 0; j < n; j++)
+      for(i = 0; i < m; i++)
+	C[i + (size_t)j*ldc] = beta == 0 ? 0 : beta * C[i + (size_t)j*ldc];
+  }
+  if(k <= 0)
+    return 0;
+  double* bufA = (double*)aligned_alloc_64((size_t)MC*KC*sizeof(double));
+  double* bufB = (double*)aligned_alloc_64((size_t)KC*NC*sizeof(double));
+  if(!bufA || !bufB) {
+    printf("Error: simd_dgemm could not allocate its packing buffers.\n");
+    free(bufA);
+    free(bufB);
+    return -1;
+  }
+  double tile[MAX_MR*MAX_NR];
+  int jc, pc, ic, jr, ir;
+  for(jc = 0; jc < n; jc += NC) {
+    int nc = n - jc < NC ? n - jc : NC;
+    for(pc = 0; pc < k; pc += KC) {
+      int kc = k - pc < KC ? k - pc : KC;
+      pack_B(ki, transB, B, ldb, pc, jc, kc, nc, bufB);
+      for(ic = 0; ic < m; ic += MC) {
+	int mc = m - ic < MC ? m - ic : MC;
+	pack_A(ki, transA, A, lda, ic, pc, mc, kc, bufA);
+	for(jr = 0; jr < nc; jr += NR) {
+	  int nr = nc - jr < NR ? nc - jr : NR;
+	  const double* b = bufB + (size_t)(jr/NR)*NR*kc;
+	  for(ir = 0; ir < mc; ir += MR) {
+	    int mr = mc - ir < MR ? mc - ir : MR;
+	    const double* a = bufA + (size_t)(ir/MR)*MR*kc;
+	    double* Ctile = C + (ic+ir) + (size_t)(jc+jr)*ldc;
+	    if(mr == MR && nr == NR)
+	      ki->kernel(kc, a, b, Ctile, ldc);
+	    else {
+	      /* Edge tile: compute the full tile in a buffer, then add
+		 the part that is inside C. */
+	      memset(tile, 0, MR*NR*sizeof(double));
+	      ki->kernel(kc, a, b, tile, MR);
+	      for(j = 0; j < nr; j++)
+		for(i = 0; i < mr; i++)
+		  Ctile[i + (size_t)j*ldc] += tile[i + j*MR];
+	    }
+	  }
+	}
+      }
+    }
+  }
+  free(bufA);
+  free(bufB);
+  return 0;
+}
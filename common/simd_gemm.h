@@ -0,0 +1,35 @@
+/* Built-in matrix-matrix multiplication kernel for use when no tuned
+   BLAS library is available. The interface follows BLAS dgemm with
+   alpha = 1: C = beta*C + op(A)*op(B), column-major storage, where
+   op(X) is X or its transpose depending on transA/transB ('N' or 'T').
+
+   The implementation packs blocks of A and B into contiguous panels
+   that fit in cache and multiplies them with a register-tiled
+   micro-kernel. AVX-512, AVX2/FMA or generic C micro-kernels are
+   selected at runtime using CPUID. Setting the environment variable
+   SIMD_GEMM_KERNEL to avx512, avx2 or generic overrides the choice.
+   simd_dgemm returns 0, or -1 if its packing buffers could not be
+   allocated.
+*/
+
+#ifndef SIMD_GEMM_HEADER
+#define SIMD_GEMM_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int simd_dgemm(char transA, char transB,
+	       int m, int n, int k,
+	       const double* A, int lda,
+	       const double* B, int ldb,
+	       double beta, double* C, int ldc);
+
+/* Name of the micro-kernel that simd_dgemm uses on this machine. */
+const char* simd_dgemm_kernel_name(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,21 +3,48 @@
    some messages between the processes, measures the time it took, and
    prints out some results.
 
+   In sweep mode the same back-and-forth test is done for a range of
+   message sizes (powers of two from 1 byte up to a given maximum)
+   within one run. For each size some warm-up iterations are done
+   first and not included in the results, then the time of each
+   iteration is recorded and latency percentiles and bandwidth are
+   printed in a table that is easy to parse.
+
+   The stream, bidir and pairs modes use non-blocking MPI_Isend and
+   MPI_Irecv with a window of messages in flight at the same time:
+   stream: rank 0 streams messages to each worker in turn, the worker
+   only replies with a small acknowledgement after each window.
+   bidir: rank 0 and each worker in turn send windows to each other
+   simultaneously.
+   pairs: all ranks at once exchange windows with a partner rank in the
+   other half of the job (rank r with rank r+nProcs/2), which loads
+   many links at the same time and shows bisection bandwidth and
+   contention effects.
+
+   The collectives mode times MPI_Allreduce, MPI_Bcast, MPI_Alltoall,
+   MPI_Allgather and MPI_Reduce_scatter for message sizes from 4 bytes
+   up to a given maximum (powers of two) and for process counts 2, 4,
+   8, ... up to the total number of processes. The time of each
+   iteration is the max over all ranks taking part. The message size
+   is the size of the whole vector for Allreduce and Bcast, the size of
+   the block each rank receives for Reduce_scatter (the whole vector is
+   nprocs times larger), and the size of the block exchanged between
+   each pair of ranks for Alltoall and Allgather. Results are checked
+   after each iteration.
+
+   Times are measured with bench_seconds() from ../common/bench_timing.c
+   and results are also written to the file named by the BENCH_RESULTS
+   environment variable, if set. Compile for example like this:
+   mpicc -O2 -I../common commtest.c ../common/bench_timing.c -lm
+
    First version written by Elias Rudberg in October 2016.
 */
 
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
 #include <string.h>
-
-static double get_wall_seconds() {
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  double seconds = tv.tv_sec + (double)tv.tv_usec / 1000000;
-  return seconds;
-}
+#include "bench_timing.h"
 
 static void modifyBuf(char* buf, int bufSz) {
   for(int i = 0; i < bufSz; i+=200)
@@ -31,18 +58,12 @@ static int mainFuncMaster(int nProcsTot, int noOfMessageBatches, int messageSize
   printf("noOfMessageBatches = %d\n", noOfMessageBatches);
   printf("messageSizeInBytes = %d --> %f MB\n", messageSizeInBytes, (double)messageSizeInBytes/1000000);
   printf("nMessagesPerBatch  = %d\n", nMessagesPerBatch);
-  double timeTaken_min = -1;
-  int timeTaken_min_batchIdx = -1;
-  int timeTaken_min_slaveIdx = -1;
-  double timeTaken_max = -1;
-  int timeTaken_max_batchIdx = -1;
-  int timeTaken_max_slaveIdx = -1;
-  double timeTaken_tot = 0;
-  int counter = 0;
   char* buf1 = (char*)malloc(messageSizeInBytes);
   char* buf2 = (char*)malloc(messageSizeInBytes);
   int nSlaveProcs = nProcsTot - 1;
-  int firstTime = 1; // 1 means it is first time, 0 if not first time
+  // Time for each batch, at index batchIdx*nSlaveProcs+slaveIdx
+  double* times = (double*)malloc((size_t)noOfMessageBatches*nSlaveProcs*sizeof(double));
+  int counter = 0;
   for(int batchIdx = 0; batchIdx < noOfMessageBatches; batchIdx++) {
     for(int slaveIdx = 0; slaveIdx < nSlaveProcs; slaveIdx++) {
       // Prepare buf1 contents to send
@@ -52,7 +73,7 @@ static int mainFuncMaster(int nProcsTot, int noOfMessageBatches, int messageSize
       memcpy(buf2, buf1, messageSizeInBytes);
       for(int k = 0; k < nMessagesPerBatch; k++)
 	modifyBuf(buf2, messageSizeInBytes);
-      double startTime = get_wall_seconds();
+      double startTime = bench_seconds();
       int rankToCommunicateWith = slaveIdx + 1;
       int tag = 0;
       for(int k = 0; k < nMessagesPerBatch; k++) {
@@ -61,20 +82,7 @@ static int mainFuncMaster(int nProcsTot, int noOfMessageBatches, int messageSize
 	// Receive message into buf1 (overwriting previous buf1 contents)
 	MPI_Recv(buf1, messageSizeInBytes, MPI_UNSIGNED_CHAR, rankToCommunicateWith, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
       }
-      double timeTaken = get_wall_seconds() - startTime;
-      if(firstTime || timeTaken < timeTaken_min) {
-	timeTaken_min = timeTaken;
-	timeTaken_min_batchIdx = batchIdx;
-	timeTaken_min_slaveIdx = slaveIdx;
-      }
-      if(firstTime || timeTaken > timeTaken_max) {
-	timeTaken_max = timeTaken;
-	timeTaken_max_batchIdx = batchIdx;
-	timeTaken_max_slaveIdx = slaveIdx;
-      }
-      timeTaken_tot += timeTaken;
-      firstTime = 0;
-      counter++;
+      times[counter++] = bench_seconds() - startTime;
       // Verify that received data is correct, by comparing to buf2 contents.
       if(memcmp(buf1, buf2, messageSizeInBytes) != 0) {
 	printf("ERROR: received data not correct.\n");
@@ -82,13 +90,25 @@ static int mainFuncMaster(int nProcsTot, int noOfMessageBatches, int messageSize
       }
     }
   }
-  double timeTaken_avg = timeTaken_tot / counter;
+  BenchStats stats;
+  bench_compute_stats(times, counter, &stats);
+  double timeTaken_min = stats.min;
+  double timeTaken_max = stats.max;
+  double timeTaken_avg = stats.mean;
+  int minIdx = 0, maxIdx = 0;
+  for(int i = 0; i < counter; i++) {
+    if(times[i] < times[minIdx])
+      minIdx = i;
+    if(times[i] > times[maxIdx])
+      maxIdx = i;
+  }
   printf("OK, communication test done. Results (times in wall seconds):\n");
   printf("timeTaken_min = %f\n", timeTaken_min);
   printf("timeTaken_max = %f\n", timeTaken_max);
   printf("timeTaken_avg = %f\n", timeTaken_avg);
-  printf("min time occurred for batchIdx %d and slaveIdx %d\n", timeTaken_min_batchIdx, timeTaken_min_slaveIdx);
-  printf("max time occurred for batchIdx %d and slaveIdx %d\n", timeTaken_max_batchIdx, timeTaken_max_slaveIdx);
+  printf("timeTaken_median = %f (95%% CI %f - %f)\n", stats.median, stats.ciLow, stats.ciHigh);
+  printf("min time occurred for batchIdx %d and slaveIdx %d\n", minIdx / nSlaveProcs, minIdx % nSlaveProcs);
+  printf("max time occurred for batchIdx %d and slaveIdx %d\n", maxIdx / nSlaveProcs, maxIdx % nSlaveProcs);
   int factor = 2*nMessagesPerBatch; // Use factor 2*nMessagesPerBatch here because there are 2 messages sent, back and forth
   // Estimate latency time for one message
   double latency_one_msg_min = timeTaken_min / factor;
@@ -105,11 +125,374 @@ static int mainFuncMaster(int nProcsTot, int noOfMessageBatches, int messageSize
   printf("bandwidth_best    = %f GB/second\n", bandwidth_best_GB_per_sec);
   printf("bandwidth_worst   = %f GB/second\n", bandwidth_worst_GB_per_sec);
   printf("bandwidth_typical = %f GB/second\n", bandwidth_typical_GB_per_sec);
+  char params[128];
+  snprintf(params, sizeof(params), "nProcs=%d size=%d nMessagesPerBatch=%d", nProcsTot, messageSizeInBytes, nMessagesPerBatch);
+  bench_write_result("commtest", "batch_round_trips", params, &stats);
+  free(times);
   free(buf1);
   free(buf2);
   return 0;
 }
 
+/* Next message size in sweep mode: double, but make sure the maximum
+   size itself is included. Returns 0 after the maximum. The size is
+   only doubled when that stays within the maximum, so this works for
+   any int maximum without overflow. */
+static int nextSweepMessageSize(int messageSizeInBytes, int maxMessageSizeInBytes) {
+  if(messageSizeInBytes >= maxMessageSizeInBytes)
+    return 0;
+  if(messageSizeInBytes > maxMessageSizeInBytes / 2)
+    return maxMessageSizeInBytes;
+  return messageSizeInBytes * 2;
+}
+
+static int mainFuncMasterSweep(int nProcsTot, int maxMessageSizeInBytes, int nIterations, int nWarmupIterations) {
+  // Same as mainFuncMaster, but for a range of message sizes and with statistics computed from each iteration.
+  printf("Doing communication test in sweep mode with the following parameters:\n");
+  printf("nProcsTot             = %d\n", nProcsTot);
+  printf("maxMessageSizeInBytes = %d --> %f MB\n", maxMessageSizeInBytes, (double)maxMessageSizeInBytes/1000000);
+  printf("nIterations           = %d\n", nIterations);
+  printf("nWarmupIterations     = %d\n", nWarmupIterations);
+  int nSlaveProcs = nProcsTot - 1;
+  // Latency samples for one message size, from all slaves.
+  double* latencies = (double*)malloc((size_t)nIterations*nSlaveProcs*sizeof(double));
+  char* buf1 = (char*)malloc(maxMessageSizeInBytes);
+  char* buf2 = (char*)malloc(maxMessageSizeInBytes);
+  printf("Results table, latency is half the round-trip time, bandwidth is message size divided by latency:\n");
+  printf("# %12s %10s %12s %12s %12s %12s %14s %14s\n", "size_bytes", "n_samples",
+	 "lat_p50_us", "lat_p90_us", "lat_p99_us", "lat_max_us", "bw_p50_GB_s", "bw_best_GB_s");
+  for(int messageSizeInBytes = 1; messageSizeInBytes > 0; messageSizeInBytes = nextSweepMessageSize(messageSizeInBytes, maxMessageSizeInBytes)) {
+    int nSamples = 0;
+    for(int slaveIdx = 0; slaveIdx < nSlaveProcs; slaveIdx++) {
+      // Prepare buf1 contents to send
+      for(int i = 0; i < messageSizeInBytes; i++)
+	buf1[i] = rand() % 77;
+      // Prepare expected received buf contents in buf2
+      memcpy(buf2, buf1, messageSizeInBytes);
+      for(int k = 0; k < nWarmupIterations + nIterations; k++)
+	modifyBuf(buf2, messageSizeInBytes);
+      int rankToCommunicateWith = slaveIdx + 1;
+      int tag = 0;
+      for(int k = 0; k < nWarmupIterations + nIterations; k++) {
+	double startTime = bench_seconds();
+	MPI_Send(buf1, messageSizeInBytes, MPI_UNSIGNED_CHAR, rankToCommunicateWith, tag, MPI_COMM_WORLD);
+	MPI_Recv(buf1, messageSizeInBytes, MPI_UNSIGNED_CHAR, rankToCommunicateWith, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+	double timeTaken = bench_seconds() - startTime;
+	if(k >= nWarmupIterations)
+	  latencies[nSamples++] = timeTaken / 2;
+      }
+      // Verify that received data is correct, by comparing to buf2 contents.
+      if(memcmp(buf1, buf2, messageSizeInBytes) != 0) {
+	printf("ERROR: received data not correct.\n");
+	return -1;
+      }
+    }
+    BenchStats stats;
+    bench_compute_stats(latencies, nSamples, &stats);
+    double messageSizeInGB = (double)messageSizeInBytes/(1e9);
+    printf("  %12d %10d %12.3f %12.3f %12.3f %12.3f %14.6f %14.6f\n", messageSizeInBytes, nSamples,
+	   stats.median*1e6, stats.p90*1e6, stats.p99*1e6, stats.max*1e6, messageSizeInGB / stats.median, messageSizeInGB / stats.min);
+    char params[64];
+    snprintf(params, sizeof(params), "nProcs=%d size=%d", nProcsTot, messageSizeInBytes);
+    bench_write_result("commtest", "sweep_latency", params, &stats);
+  }
+  free(latencies);
+  free(buf1);
+  free(buf2);
+  return 0;
+}
+
+/* Fills a message with contents determined by seed, so that the
+   receiver can check the data without it being sent separately. */
+static void fillMessage(char* buf, int bufSz, int seed) {
+  for(int i = 0; i < bufSz; i++)
+    buf[i] = (char)(((long long)seed + (long long)i*7) % 251);
+}
+
+static int messageSeed(int senderRank, int iteration, int windowSize, int msgIdx) {
+  return (int)(((long long)senderRank*1000003 + (long long)iteration*windowSize + msgIdx) % 100000007);
+}
+
+/* Sends and/or receives a window of messages to/from partner, all in
+   flight at once. Message m goes from/to offset m*messageSizeInBytes
+   in sendBuf/recvBuf. */
+static void exchangeWindow(int partner, int doSend, int doRecv, char* sendBuf, char* recvBuf,
+			   int messageSizeInBytes, int windowSize, MPI_Request* requests) {
+  int nRequests = 0;
+  if(doRecv)
+    for(int m = 0; m < windowSize; m++)
+      MPI_Irecv(recvBuf+(size_t)m*messageSizeInBytes, messageSizeInBytes, MPI_UNSIGNED_CHAR, partner, m, MPI_COMM_WORLD, &requests[nRequests++]);
+  if(doSend)
+    for(int m = 0; m < windowSize; m++)
+      MPI_Isend(sendBuf+(size_t)m*messageSizeInBytes, messageSizeInBytes, MPI_UNSIGNED_CHAR, partner, m, MPI_COMM_WORLD, &requests[nRequests++]);
+  MPI_Waitall(nRequests, requests, MPI_STATUSES_IGNORE);
+}
+
+static void fillWindow(char* sendBuf, int myRank, int iteration, int messageSizeInBytes, int windowSize) {
+  for(int m = 0; m < windowSize; m++)
+    fillMessage(sendBuf+(size_t)m*messageSizeInBytes, messageSizeInBytes, messageSeed(myRank, iteration, windowSize, m));
+}
+
+/* Returns the number of messages in the window that do not have the
+   contents expected from senderRank. */
+static int checkWindow(const char* recvBuf, char* expectedBuf, int senderRank, int iteration, int messageSizeInBytes, int windowSize) {
+  int nErrors = 0;
+  for(int m = 0; m < windowSize; m++) {
+    fillMessage(expectedBuf, messageSizeInBytes, messageSeed(senderRank, iteration, windowSize, m));
+    if(memcmp(recvBuf+(size_t)m*messageSizeInBytes, expectedBuf, messageSizeInBytes) != 0)
+      nErrors++;
+  }
+  return nErrors;
+}
+
+/* Runs the stream, bidir or pairs mode, see the comment at the top of
+   this file. Iteration 0 is a warm-up iteration that is not included
+   in the results. */
+static int mainFuncWindowed(const char* mode, int nProcs, int myRank, int messageSizeInBytes, int nIterations, int windowSize) {
+  int isStream = strcmp(mode, "stream") == 0;
+  int isPairs = strcmp(mode, "pairs") == 0;
+  size_t windowSizeInBytes = (size_t)windowSize*messageSizeInBytes;
+  char* sendBuf = (char*)malloc(windowSizeInBytes);
+  char* recvBuf = (char*)malloc(windowSizeInBytes);
+  char* expectedBuf = (char*)malloc(messageSizeInBytes);
+  MPI_Request* requests = (MPI_Request*)malloc(2*windowSize*sizeof(MPI_Request));
+  double* times = (double*)malloc(nIterations*sizeof(double));
+  // Bytes moved per iteration, counting both directions for bidir and all ranks for pairs
+  double bytesPerIteration = (double)windowSizeInBytes * (isStream ? 1 : 2);
+  if(isPairs)
+    bytesPerIteration = (double)windowSizeInBytes * nProcs;
+  if(myRank == 0) {
+    printf("Doing communication test in %s mode with the following parameters:\n", mode);
+    printf("nProcsTot          = %d\n", nProcs);
+    printf("messageSizeInBytes = %d --> %f MB\n", messageSizeInBytes, (double)messageSizeInBytes/1000000);
+    printf("nIterations        = %d (plus one warm-up iteration)\n", nIterations);
+    printf("windowSize         = %d messages in flight\n", windowSize);
+    printf("# %10s %10s %14s %14s %14s\n", "partners", "n_samples", "time_p50_us", "bw_p50_GB_s", "bw_best_GB_s");
+  }
+  int nErrors = 0;
+  int nPairings = isPairs ? 1 : nProcs-1;
+  for(int pairingIdx = 0; pairingIdx < nPairings; pairingIdx++) {
+    // For stream and bidir, rank 0 works with worker pairingIdx+1 while the other workers wait.
+    int partner;
+    if(isPairs)
+      partner = (myRank + nProcs/2) % nProcs;
+    else if(myRank == 0)
+      partner = pairingIdx + 1;
+    else if(myRank == pairingIdx + 1)
+      partner = 0;
+    else
+      continue;
+    int doSend = !isStream || myRank == 0;
+    int doRecv = !isStream || myRank != 0;
+    for(int iteration = 0; iteration <= nIterations; iteration++) {
+      if(doSend)
+	fillWindow(sendBuf, myRank, iteration, messageSizeInBytes, windowSize);
+      if(isPairs)
+	MPI_Barrier(MPI_COMM_WORLD);
+      double startTime = bench_seconds();
+      exchangeWindow(partner, doSend, doRecv, sendBuf, recvBuf, messageSizeInBytes, windowSize, requests);
+      if(isStream) {
+	// The acknowledgement ends the iteration for the sender
+	char ack = 1;
+	if(myRank == 0)
+	  MPI_Recv(&ack, 1, MPI_CHAR, partner, windowSize, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+	else
+	  MPI_Send(&ack, 1, MPI_CHAR, partner, windowSize, MPI_COMM_WORLD);
+      }
+      double timeTaken = bench_seconds() - startTime;
+      if(isPairs) {
+	// An iteration is done when the slowest pair is done
+	double timeTaken_max;
+	MPI_Allreduce(&timeTaken, &timeTaken_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+	timeTaken = timeTaken_max;
+      }
+      if(iteration > 0)
+	times[iteration-1] = timeTaken;
+      if(doRecv)
+	nErrors += checkWindow(recvBuf, expectedBuf, partner, iteration, messageSizeInBytes, windowSize);
+    }
+    if(myRank == 0) {
+      BenchStats stats;
+      bench_compute_stats(times, nIterations, &stats);
+      char partnersStr[32];
+      if(isPairs)
+	snprintf(partnersStr, sizeof(partnersStr), "all");
+      else
+	snprintf(partnersStr, sizeof(partnersStr), "0<->%d", partner);
+      printf("  %10s %10d %14.3f %14.6f %14.6f\n", partnersStr, nIterations, stats.median*1e6,
+	     bytesPerIteration/1e9 / stats.median, bytesPerIteration/1e9 / stats.min);
+      char params[128];
+      snprintf(params, sizeof(params), "nProcs=%d partners=%s size=%d window=%d", nProcs, partnersStr, messageSizeInBytes, windowSize);
+      bench_write_result("commtest", mode, params, &stats);
+    }
+  }
+  // Verification result is collected from all ranks
+  int nErrors_tot = 0;
+  MPI_Reduce(&nErrors, &nErrors_tot, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  free(sendBuf);
+  free(recvBuf);
+  free(expectedBuf);
+  free(requests);
+  free(times);
+  if(myRank == 0 && nErrors_tot != 0) {
+    printf("ERROR: received data not correct for %d messages.\n", nErrors_tot);
+    return -1;
+  }
+  return 0;
+}
+
+enum { COLL_ALLREDUCE, COLL_BCAST, COLL_ALLTOALL, COLL_ALLGATHER, COLL_REDUCE_SCATTER, N_COLLECTIVES };
+static const char* collectiveNames[N_COLLECTIVES] = { "Allreduce", "Bcast", "Alltoall", "Allgather", "Reduce_scatter" };
+
+/* Prepares input buffers for one iteration of a collective. Integer
+   data is used for the reductions so that results can be checked
+   exactly. */
+static void prepareCollective(int op, int rank, int p, int messageSizeInBytes, char* sendBuf, char* recvBuf) {
+  int count = messageSizeInBytes / sizeof(int);
+  int* sendInts = (int*)sendBuf;
+  memset(recvBuf, 0, (size_t)p*messageSizeInBytes);
+  if(op == COLL_ALLREDUCE || op == COLL_REDUCE_SCATTER) {
+    int nInts = op == COLL_ALLREDUCE ? count : count*p;
+    for(int i = 0; i < nInts; i++)
+      sendInts[i] = rank + i;
+  }
+  else if(op == COLL_BCAST) {
+    if(rank == 0)
+      fillMessage(recvBuf, messageSizeInBytes, 12345);
+  }
+  else if(op == COLL_ALLTOALL) {
+    for(int dest = 0; dest < p; dest++)
+      fillMessage(sendBuf+(size_t)dest*messageSizeInBytes, messageSizeInBytes, rank*p+dest);
+  }
+  else if(op == COLL_ALLGATHER)
+    fillMessage(sendBuf, messageSizeInBytes, rank);
+}
+
+static void runCollective(int op, MPI_Comm comm, int messageSizeInBytes, char* sendBuf, char* recvBuf, int* recvCounts) {
+  int count = messageSizeInBytes / sizeof(int);
+  if(op == COLL_ALLREDUCE)
+    MPI_Allreduce(sendBuf, recvBuf, count, MPI_INT, MPI_SUM, comm);
+  else if(op == COLL_BCAST)
+    MPI_Bcast(recvBuf, messageSizeInBytes, MPI_UNSIGNED_CHAR, 0, comm);
+  else if(op == COLL_ALLTOALL)
+    MPI_Alltoall(sendBuf, messageSizeInBytes, MPI_UNSIGNED_CHAR, recvBuf, messageSizeInBytes, MPI_UNSIGNED_CHAR, comm);
+  else if(op == COLL_ALLGATHER)
+    MPI_Allgather(sendBuf, messageSizeInBytes, MPI_UNSIGNED_CHAR, recvBuf, messageSizeInBytes, MPI_UNSIGNED_CHAR, comm);
+  else if(op == COLL_REDUCE_SCATTER)
+    MPI_Reduce_scatter(sendBuf, recvBuf, recvCounts, MPI_INT, MPI_SUM, comm);
+}
+
+/* Returns 1 if recvBuf contains the expected result of the collective,
+   otherwise 0. The expected result is built in expectedBuf. */
+static int checkCollective(int op, int rank, int p, int messageSizeInBytes, const char* recvBuf, char* expectedBuf) {
+  int count = messageSizeInBytes / sizeof(int);
+  int* expectedInts = (int*)expectedBuf;
+  size_t nBytesToCompare = messageSizeInBytes;
+  /* Sum over ranks r of (r + i) is p*(p-1)/2 + p*i, computed in a wider
+     type and wrapped to int like the MPI_INT sum */
+  if(op == COLL_ALLREDUCE) {
+    for(int i = 0; i < count; i++)
+      expectedInts[i] = (int)(unsigned int)((long long)p*(p-1)/2 + (long long)p*i);
+    nBytesToCompare = count*sizeof(int);
+  }
+  else if(op == COLL_REDUCE_SCATTER) {
+    for(int i = 0; i < count; i++)
+      expectedInts[i] = (int)(unsigned int)((long long)p*(p-1)/2 + (long long)p*((long long)rank*count+i));
+    nBytesToCompare = count*sizeof(int);
+  }
+  else if(op == COLL_BCAST)
+    fillMessage(expectedBuf, messageSizeInBytes, 12345);
+  else if(op == COLL_ALLTOALL) {
+    for(int src = 0; src < p; src++)
+      fillMessage(expectedBuf+(size_t)src*messageSizeInBytes, messageSizeInBytes, src*p+rank);
+    nBytesToCompare = (size_t)p*messageSizeInBytes;
+  }
+  else if(op == COLL_ALLGATHER) {
+    for(int src = 0; src < p; src++)
+      fillMessage(expectedBuf+(size_t)src*messageSizeInBytes, messageSizeInBytes, src);
+    nBytesToCompare = (size_t)p*messageSizeInBytes;
+  }
+  return memcmp(recvBuf, expectedBuf, nBytesToCompare) == 0;
+}
+
+static int mainFuncCollectives(int nProcs, int myRank, int maxMessageSizeInBytes, int nIterations, int nWarmupIterations) {
+  if(myRank == 0) {
+    printf("Doing collective communication test with the following parameters:\n");
+    printf("nProcsTot             = %d\n", nProcs);
+    printf("maxMessageSizeInBytes = %d --> %f MB\n", maxMessageSizeInBytes, (double)maxMessageSizeInBytes/1000000);
+    printf("nIterations           = %d\n", nIterations);
+    printf("nWarmupIterations     = %d\n", nWarmupIterations);
+    printf("Results table, times are max over ranks, algbw is message size divided by time:\n");
+    printf("# %-15s %6s %12s %10s %12s %12s %12s %12s\n", "collective", "nprocs", "size_bytes", "n_samples",
+	   "time_p50_us", "time_min_us", "time_max_us", "algbw_GB_s");
+  }
+  // Buffers large enough for the largest collective, Reduce_scatter/Alltoall/Allgather on all processes
+  size_t bufSize = (size_t)nProcs*maxMessageSizeInBytes;
+  char* sendBuf = (char*)malloc(bufSize);
+  char* recvBuf = (char*)malloc(bufSize);
+  char* expectedBuf = (char*)malloc(bufSize);
+  int* recvCounts = (int*)malloc(nProcs*sizeof(int));
+  double* times = (double*)malloc(nIterations*sizeof(double));
+  int nErrors = 0;
+  for(int p = 2; p <= nProcs; ) {
+    // Communicator with the first p ranks, the others wait
+    MPI_Comm comm;
+    MPI_Comm_split(MPI_COMM_WORLD, myRank < p ? 0 : MPI_UNDEFINED, myRank, &comm);
+    if(myRank < p) {
+      for(int op = 0; op < N_COLLECTIVES; op++) {
+	for(int messageSizeInBytes = sizeof(int); messageSizeInBytes <= maxMessageSizeInBytes; messageSizeInBytes *= 2) {
+	  for(int i = 0; i < p; i++)
+	    recvCounts[i] = messageSizeInBytes / sizeof(int);
+	  for(int k = 0; k < nWarmupIterations + nIterations; k++) {
+	    prepareCollective(op, myRank, p, messageSizeInBytes, sendBuf, recvBuf);
+	    MPI_Barrier(comm);
+	    double startTime = bench_seconds();
+	    runCollective(op, comm, messageSizeInBytes, sendBuf, recvBuf, recvCounts);
+	    double timeTaken = bench_seconds() - startTime;
+	    double timeTaken_max;
+	    MPI_Allreduce(&timeTaken, &timeTaken_max, 1, MPI_DOUBLE, MPI_MAX, comm);
+	    if(k >= nWarmupIterations)
+	      times[k-nWarmupIterations] = timeTaken_max;
+	    if(!checkCollective(op, myRank, p, messageSizeInBytes, recvBuf, expectedBuf))
+	      nErrors++;
+	  }
+	  if(myRank == 0) {
+	    BenchStats stats;
+	    bench_compute_stats(times, nIterations, &stats);
+	    printf("  %-15s %6d %12d %10d %12.3f %12.3f %12.3f %12.6f\n", collectiveNames[op], p, messageSizeInBytes, nIterations,
+		   stats.median*1e6, stats.min*1e6, stats.max*1e6, (double)messageSizeInBytes/1e9 / stats.median);
+	    char params[64];
+	    snprintf(params, sizeof(params), "nProcs=%d size=%d", p, messageSizeInBytes);
+	    bench_write_result("commtest", collectiveNames[op], params, &stats);
+	  }
+	  // Stop before doubling would go past the maximum, or overflow
+	  if(messageSizeInBytes > maxMessageSizeInBytes / 2)
+	    break;
+	}
+      }
+      MPI_Comm_free(&comm);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    // Next process count: double, but make sure nProcs itself is included
+    if(p < nProcs && p > nProcs / 2)
+      p = nProcs;
+    else
+      p *= 2;
+  }
+  int nErrors_tot = 0;
+  MPI_Reduce(&nErrors, &nErrors_tot, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  free(sendBuf);
+  free(recvBuf);
+  free(expectedBuf);
+  free(recvCounts);
+  free(times);
+  if(myRank == 0 && nErrors_tot != 0) {
+    printf("ERROR: collective results not correct in %d cases.\n", nErrors_tot);
+    return -1;
+  }
+  return 0;
+}
+
 static int mainFuncSlave(int noOfMessageBatches, int messageSizeInBytes, int nMessagesPerBatch) {
   // This is a "slave" process, it's job is simply to wait for messages and send a response back each time a message arrives.
   char* buf = (char*)malloc(messageSizeInBytes);
@@ -127,6 +510,22 @@ static int mainFuncSlave(int noOfMessageBatches, int messageSizeInBytes, int nMe
   return 0;
 }
 
+static int mainFuncSlaveSweep(int maxMessageSizeInBytes, int nIterations, int nWarmupIterations) {
+  // Slave part of sweep mode, goes through the same message sizes as mainFuncMasterSweep.
+  char* buf = (char*)malloc(maxMessageSizeInBytes);
+  for(int messageSizeInBytes = 1; messageSizeInBytes > 0; messageSizeInBytes = nextSweepMessageSize(messageSizeInBytes, maxMessageSizeInBytes)) {
+    for(int k = 0; k < nWarmupIterations + nIterations; k++) {
+      int rankToCommunicateWith = 0;
+      int tag = 0;
+      MPI_Recv(buf, messageSizeInBytes, MPI_UNSIGNED_CHAR, rankToCommunicateWith, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+      modifyBuf(buf, messageSizeInBytes);
+      MPI_Send(buf, messageSizeInBytes, MPI_UNSIGNED_CHAR, rankToCommunicateWith, tag, MPI_COMM_WORLD);
+    }
+  }
+  free(buf);
+  return 0;
+}
+
 int main(int argc, const char* argv[]) {
   MPI_Init(0, 0);
   int nProcs;
@@ -137,8 +536,64 @@ int main(int argc, const char* argv[]) {
     printf("Please run this test with at least two MPI processes.\n");
     return -1;
   }
+  if(argc == 5 && strcmp(argv[1], "sweep") == 0) {
+    int maxMessageSizeInBytes = atoi(argv[2]);
+    int nIterations = atoi(argv[3]);
+    int nWarmupIterations = atoi(argv[4]);
+    if(maxMessageSizeInBytes <= 0 || nIterations <= 0 || nWarmupIterations < 0) {
+      printf("Error: (maxMessageSizeInBytes <= 0 || nIterations <= 0 || nWarmupIterations < 0).\n");
+      return -1;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    int resultCode = 0;
+    if(myRank == 0)
+      resultCode = mainFuncMasterSweep(nProcs, maxMessageSizeInBytes, nIterations, nWarmupIterations);
+    else
+      resultCode = mainFuncSlaveSweep(maxMessageSizeInBytes, nIterations, nWarmupIterations);
+    if(resultCode == 0 && myRank == 0)
+      printf("MPI communication test finished OK.\n");
+    MPI_Finalize();
+    return 0;
+  }
+  if(argc == 5 && strcmp(argv[1], "collectives") == 0) {
+    int maxMessageSizeInBytes = atoi(argv[2]);
+    int nIterations = atoi(argv[3]);
+    int nWarmupIterations = atoi(argv[4]);
+    if(maxMessageSizeInBytes < (int)sizeof(int) || nIterations <= 0 || nWarmupIterations < 0) {
+      printf("Error: (maxMessageSizeInBytes < %d || nIterations <= 0 || nWarmupIterations < 0).\n", (int)sizeof(int));
+      return -1;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    int resultCode = mainFuncCollectives(nProcs, myRank, maxMessageSizeInBytes, nIterations, nWarmupIterations);
+    if(resultCode == 0 && myRank == 0)
+      printf("MPI communication test finished OK.\n");
+    MPI_Finalize();
+    return 0;
+  }
+  if(argc == 5 && (strcmp(argv[1], "stream") == 0 || strcmp(argv[1], "bidir") == 0 || strcmp(argv[1], "pairs") == 0)) {
+    int messageSizeInBytes = atoi(argv[2]);
+    int nIterations = atoi(argv[3]);
+    int windowSize = atoi(argv[4]);
+    if(messageSizeInBytes <= 0 || nIterations <= 0 || windowSize <= 0) {
+      printf("Error: (messageSizeInBytes <= 0 || nIterations <= 0 || windowSize <= 0).\n");
+      return -1;
+    }
+    if(strcmp(argv[1], "pairs") == 0 && nProcs % 2 != 0) {
+      printf("Error: pairs mode needs an even number of MPI processes.\n");
+      return -1;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    int resultCode = mainFuncWindowed(argv[1], nProcs, myRank, messageSizeInBytes, nIterations, windowSize);
+    if(resultCode == 0 && myRank == 0)
+      printf("MPI communication test finished OK.\n");
+    MPI_Finalize();
+    return 0;
+  }
   if(argc != 4) {
     printf("Please give 3 arguments: noOfMessageBatches messageSizeInBytes nMessagesPerBatch\n");
+    printf("or, for sweep mode, 4 arguments: sweep maxMessageSizeInBytes nIterations nWarmupIterations\n");
+    printf("or, for windowed modes, 4 arguments: stream|bidir|pairs messageSizeInBytes nIterations windowSize\n");
+    printf("or, for collectives mode, 4 arguments: collectives maxMessageSizeInBytes nIterations nWarmupIterations\n");
     return -1;
   }
   int noOfMessageBatches = atoi(argv[1]);
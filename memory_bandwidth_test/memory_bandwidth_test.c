@@ -0,0 +1,327 @@
+/* This program measures memory bandwidth using the four STREAM
+   kernels (copy, scale, add, triad), each also in a variant using
+   non-temporal (streaming) stores that bypass the cache. Several
+   threads work on separate slices of the arrays, in the same way as
+   in threaded_clock_freq_test, and a sweep is done over thread counts
+   1, 2, ..., maxThreads.
+
+   Each thread initializes its own slice of the arrays before the
+   timing starts, so that with the usual first-touch policy the memory
+   pages are placed on the NUMA node of the thread that uses them
+   ("local" placement). If there is more than one socket, the sweep is
+   repeated with each slice first touched from a CPU on another socket
+   before the thread moves to its own CPU ("remote" placement). Threads
+   are pinned according to an affinity policy, see
+   ../common/cpu_topology.h.
+
+   Bandwidth is computed from the best time over the repetitions, not
+   counting the first one, with the same byte counts as STREAM (reads
+   plus writes, no write-allocate traffic). The results are checked
+   at the end.
+
+   Compile for example like this:
+   gcc -O2 -I../common memory_bandwidth_test.c ../common/cpu_topology.c ../common/bench_timing.c -lpthread -lm
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "cpu_topology.h"
+#include "bench_timing.h"
+
+enum { KERNEL_COPY, KERNEL_SCALE, KERNEL_ADD, KERNEL_TRIAD,
+       KERNEL_COPY_NT, KERNEL_SCALE_NT, KERNEL_ADD_NT, KERNEL_TRIAD_NT, N_KERNELS };
+static const char* kernelNames[N_KERNELS] = { "Copy", "Scale", "Add", "Triad",
+					      "Copy_nt", "Scale_nt", "Add_nt", "Triad_nt" };
+static const int kernelBytesPerElement[N_KERNELS] = { 16, 16, 24, 24, 16, 16, 24, 24 };
+
+/* With scalar = sqrt(2)-1 one round of copy, scale, add, triad leaves
+   a unchanged, so the values stay bounded for any number of
+   repetitions. */
+static const double scalar = 0.41421356237309515;
+
+double* a_global = NULL;
+double* b_global = NULL;
+double* c_global = NULL;
+int nRepetitions_global = 0;
+
+typedef struct {
+  int threadIdx;
+  int initCpu; // CPU used for first touch, -1 means not pinned
+  int workCpu; // CPU used for the kernels, -1 means not pinned
+  long int start;
+  long int end;
+  pthread_barrier_t* barrier;
+  double* kernelTimes; // N_KERNELS*nRepetitions, written by thread 0
+} ThreadStruct;
+
+static void run_kernel(int kernel, long int start, long int end) {
+  double* a = a_global;
+  double* b = b_global;
+  double* c = c_global;
+  long int j;
+#ifndef __SSE2__
+  // No streaming store intrinsics available, use ordinary stores
+  if(kernel >= KERNEL_COPY_NT)
+    kernel -= KERNEL_COPY_NT;
+#else
+  __m128d s2 = _mm_set1_pd(scalar);
+#endif
+  switch(kernel) {
+  case KERNEL_COPY:
+    for(j = start; j < end; j++)
+      c[j] = a[j];
+    break;
+  case KERNEL_SCALE:
+    for(j = start; j < end; j++)
+      b[j] = scalar*c[j];
+    break;
+  case KERNEL_ADD:
+    for(j = start; j < end; j++)
+      c[j] = a[j]+b[j];
+    break;
+  case KERNEL_TRIAD:
+    for(j = start; j < end; j++)
+      a[j] = b[j]+scalar*c[j];
+    break;
+#ifdef __SSE2__
+    // Slices are 64-byte aligned with an even number of elements
+  case KERNEL_COPY_NT:
+    for(j = start; j < end; j += 2)
+      _mm_stream_pd(&c[j], _mm_load_pd(&a[j]));
+    _mm_sfence();
+    break;
+  case KERNEL_SCALE_NT:
+    for(j = start; j < end; j += 2)
+      _mm_stream_pd(&b[j], _mm_mul_pd(s2, _mm_load_pd(&c[j])));
+    _mm_sfence();
+    break;
+  case KERNEL_ADD_NT:
+    for(j = start; j < end; j += 2)
+      _mm_stream_pd(&c[j], _mm_add_pd(_mm_load_pd(&a[j]), _mm_load_pd(&b[j])));
+    _mm_sfence();
+    break;
+  case KERNEL_TRIAD_NT:
+    for(j = start; j < end; j += 2)
+      _mm_stream_pd(&a[j], _mm_add_pd(_mm_load_pd(&b[j]), _mm_mul_pd(s2, _mm_load_pd(&c[j]))));
+    _mm_sfence();
+    break;
+#endif
+  }
+}
+
+static void* thread_func(void* arg) {
+  ThreadStruct* s = (ThreadStruct*)arg;
+  // First touch decides on which NUMA node the pages end up
+  if(s->initCpu >= 0 && pin_current_thread(s->initCpu) != 0)
+    printf("Warning: pthread_setaffinity_np failed for cpu %d.\n", s->initCpu);
+  long int j;
+  for(j = s->start; j < s->end; j++) {
+    a_global[j] = 1.0;
+    b_global[j] = 2.0;
+    c_global[j] = 0.0;
+  }
+  if(s->workCpu != s->initCpu && pin_current_thread(s->workCpu) != 0)
+    printf("Warning: pthread_setaffinity_np failed for cpu %d.\n", s->workCpu);
+  int rep, kernel;
+  for(rep = 0; rep < nRepetitions_global; rep++) {
+    for(kernel = 0; kernel < N_KERNELS; kernel++) {
+      pthread_barrier_wait(s->barrier);
+      double startTime = bench_seconds();
+      run_kernel(kernel, s->start, s->end);
+      pthread_barrier_wait(s->barrier);
+      if(s->threadIdx == 0)
+	s->kernelTimes[rep*N_KERNELS+kernel] = bench_seconds() - startTime;
+    }
+  }
+  return NULL;
+}
+
+/* Checks the arrays against the same sequence of operations done on
+   scalars. Returns the number of wrong elements. */
+static long int check_results(long int n) {
+  double aj = 1.0, bj = 2.0, cj = 0.0;
+  int rep, kernel;
+  for(rep = 0; rep < nRepetitions_global; rep++) {
+    for(kernel = 0; kernel < N_KERNELS; kernel++) {
+      switch(kernel % KERNEL_COPY_NT) {
+      case KERNEL_COPY:  cj = aj; break;
+      case KERNEL_SCALE: bj = scalar*cj; break;
+      case KERNEL_ADD:   cj = aj+bj; break;
+      case KERNEL_TRIAD: aj = bj+scalar*cj; break;
+      }
+    }
+  }
+  const double tol = 1e-8;
+  long int nErrors = 0;
+  long int j;
+  for(j = 0; j < n; j++) {
+    if(fabs(a_global[j]-aj) > tol*fabs(aj) ||
+       fabs(b_global[j]-bj) > tol*fabs(bj) ||
+       fabs(c_global[j]-cj) > tol*fabs(cj))
+      nErrors++;
+  }
+  return nErrors;
+}
+
+/* Runs all kernels with nThreads threads and prints one row of the
+   results table. Returns 0 on success. */
+static int do_run(int arraySizeInMB, long int n, int nThreads, const CpuInfo* cpus, int nCpus, int pin, int remote, const char* placementName) {
+  if(posix_memalign((void**)&a_global, 64, n*sizeof(double)) != 0 ||
+     posix_memalign((void**)&b_global, 64, n*sizeof(double)) != 0 ||
+     posix_memalign((void**)&c_global, 64, n*sizeof(double)) != 0) {
+    printf("Error: failed to allocate arrays.\n");
+    return -1;
+  }
+  double* kernelTimes = (double*)malloc(N_KERNELS*nRepetitions_global*sizeof(double));
+  pthread_barrier_t barrier;
+  pthread_barrier_init(&barrier, NULL, nThreads);
+  pthread_t threads[nThreads];
+  ThreadStruct threadStructs[nThreads];
+  // Slices are multiples of 8 elements so that they are 64-byte aligned
+  long int sliceSize = (n / nThreads) / 8 * 8;
+  int i;
+  for(i = 0; i < nThreads; i++) {
+    ThreadStruct* s = &threadStructs[i];
+    s->threadIdx = i;
+    s->workCpu = pin ? cpus[i % nCpus].cpu : -1;
+    s->initCpu = s->workCpu;
+    if(remote) {
+      // The i:th CPU, in policy order, not on the same socket
+      int workSocket = cpus[i % nCpus].socket;
+      int nOther = 0, k;
+      for(k = 0; k < nCpus; k++)
+	if(cpus[k].socket != workSocket)
+	  nOther++;
+      // With no CPU on another socket the arrays are initialized locally
+      int otherIdx = nOther > 0 ? i % nOther : -1;
+      for(k = 0; k < nCpus && otherIdx >= 0; k++) {
+	if(cpus[k].socket != workSocket) {
+	  if(otherIdx == 0) {
+	    s->initCpu = cpus[k].cpu;
+	    break;
+	  }
+	  otherIdx--;
+	}
+      }
+    }
+    s->start = i*sliceSize;
+    s->end = i == nThreads-1 ? n : (i+1)*sliceSize;
+    s->barrier = &barrier;
+    s->kernelTimes = kernelTimes;
+  }
+  for(i = 0; i < nThreads; i++) {
+    if(pthread_create(&threads[i], NULL, thread_func, &threadStructs[i]) != 0) {
+      printf("Error: pthread_create failed.\n");
+      return -1;
+    }
+  }
+  for(i = 0; i < nThreads; i++) {
+    if(pthread_join(threads[i], NULL) != 0) {
+      printf("Error: pthread_join failed.\n");
+      return -1;
+    }
+  }
+  pthread_barrier_destroy(&barrier);
+  printf("  %-9s %8d", placementName, nThreads);
+  int kernel;
+  BenchStats stats[N_KERNELS];
+  for(kernel = 0; kernel < N_KERNELS; kernel++) {
+    // Best time, skipping the first repetition if there are several
+    int firstRep = nRepetitions_global > 1 ? 1 : 0;
+    double times[nRepetitions_global];
+    int rep;
+    for(rep = firstRep; rep < nRepetitions_global; rep++)
+      times[rep-firstRep] = kernelTimes[rep*N_KERNELS+kernel];
+    bench_compute_stats(times, nRepetitions_global-firstRep, &stats[kernel]);
+    printf(" %9.2f", (double)kernelBytesPerElement[kernel]*n / stats[kernel].min / 1e9);
+  }
+  printf("\n");
+  for(kernel = 0; kernel < N_KERNELS; kernel++) {
+    char params[128];
+    snprintf(params, sizeof(params), "arraySizeInMB=%d nThreads=%d placement=%s", arraySizeInMB, nThreads, placementName);
+    bench_write_result("memory_bandwidth_test", kernelNames[kernel], params, &stats[kernel]);
+  }
+  long int nErrors = check_results(n);
+  free(kernelTimes);
+  free(a_global);
+  free(b_global);
+  free(c_global);
+  if(nErrors != 0) {
+    printf("Error: %ld array elements have wrong values.\n", nErrors);
+    return -1;
+  }
+  return 0;
+}
+
+int main (int argc, char** argv) {
+  if(argc != 4 && argc != 5) {
+    printf("Please give three or four arguments: arraySizeInMB nRepetitions maxThreads [affinityPolicy]\n");
+    printf("     arraySizeInMB: size of each of the three arrays, should be much larger than the caches.\n");
+    printf("     nRepetitions: number of times each kernel is run.\n");
+    printf("     maxThreads: a sweep is done over 1..maxThreads threads.\n");
+    printf("     affinityPolicy: none/compact/scatter/cores/smt, default compact.\n");
+    return -1;
+  }
+  int arraySizeInMB = atoi(argv[1]);
+  int nRepetitions = atoi(argv[2]);
+  int maxThreads = atoi(argv[3]);
+  const char* policy = argc == 5 ? argv[4] : "compact";
+  printf("Hello! arraySizeInMB = %d, nRepetitions = %d, maxThreads = %d, affinityPolicy = %s\n",
+	 arraySizeInMB, nRepetitions, maxThreads, policy);
+  if(arraySizeInMB <= 0 || nRepetitions <= 0 || maxThreads <= 0) {
+    printf("Error: (arraySizeInMB <= 0 || nRepetitions <= 0 || maxThreads <= 0).\n");
+    return -1;
+  }
+  nRepetitions_global = nRepetitions;
+  long int n = (long int)arraySizeInMB*1000000 / sizeof(double) / 8 * 8;
+  if(n < 8*maxThreads) {
+    printf("Error: arrays too small for %d threads.\n", maxThreads);
+    return -1;
+  }
+#ifndef __SSE2__
+  printf("Note: non-temporal stores not available, the _nt kernels use ordinary stores.\n");
+#endif
+
+  const int maxCpus = 4096;
+  CpuInfo* cpus = (CpuInfo*)malloc(maxCpus*sizeof(CpuInfo));
+  int nCpus = get_cpu_topology(cpus, maxCpus);
+  if(nCpus == 0) {
+    printf("Error: failed to get CPU topology.\n");
+    return -1;
+  }
+  print_cpu_topology(cpus, nCpus);
+  if(!order_cpus(cpus, nCpus, policy)) {
+    printf("Error: unknown affinity policy '%s'.\n", policy);
+    return -1;
+  }
+  int pin = strcmp(policy, "none") != 0;
+  int doRemote = pin && count_sockets(cpus, nCpus) > 1;
+  if(!doRemote)
+    printf("Note: remote NUMA placement skipped (needs pinning and more than one socket).\n");
+  if(pin && maxThreads > nCpus)
+    printf("Warning: maxThreads = %d > %d available CPUs, some CPUs will get more than one thread.\n", maxThreads, nCpus);
+
+  printf("Memory bandwidth in GB/s, %ld doubles per array (%.1f MB total):\n", n, 3.0*n*sizeof(double)/1e6);
+  printf("  placement nThreads");
+  int kernel;
+  for(kernel = 0; kernel < N_KERNELS; kernel++)
+    printf(" %9s", kernelNames[kernel]);
+  printf("\n");
+  int remote;
+  for(remote = 0; remote <= doRemote; remote++) {
+    int nThreads;
+    for(nThreads = 1; nThreads <= maxThreads; nThreads++) {
+      if(do_run(arraySizeInMB, n, nThreads, cpus, nCpus, pin, remote, remote ? "remote" : "local") != 0)
+	return -1;
+    }
+  }
+  free(cpus);
+  printf("Memory bandwidth test finished OK.\n");
+  return 0;
+}
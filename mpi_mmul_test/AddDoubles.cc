@@ -0,0 +1,8 @@
+#include "AddDoubles.h"
+#include "TaskProfile.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((AddDoubles));
+cht::ID AddDoubles::execute(CDouble const & x, CDouble const & y) {
+  TaskProfileScope profile("AddDoubles", 0);
+  return registerChunk( new CDouble((double)x + (double)y), cht::persistent);
+} // end execute
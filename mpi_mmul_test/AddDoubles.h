@@ -0,0 +1,10 @@
+#include "chunks_and_tasks.h"
+#include "CDouble.h"
+
+// Returns the sum of two numbers, used to add up per-leaf results
+struct AddDoubles: public cht::Task {
+  cht::ID execute(CDouble const &, CDouble const &);
+  CHT_TASK_INPUT((CDouble, CDouble));
+  CHT_TASK_OUTPUT((CDouble));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -1,59 +1,182 @@
 #include <cstring>
+#include <cmath>
+#include <atomic>
 #include "CMatrix.h"
+#include "TaskProfile.h"
+#include "LeafCodec.h"
+
+// Updated from several worker threads
+static std::atomic<size_t> bytesSerialized(0);
+
+// n, blockSize, leafType, encoding, symmetric and norm
+static const size_t HEADER_SIZE = 5*sizeof(int) + sizeof(double);
+// Children and their norms
+static const size_t CHILDREN_SIZE = 4*sizeof(cht::ChunkID) + 4*sizeof(double);
 
 CHT_CHUNK_TYPE_IMPLEMENTATION((CMatrix));
 void CMatrix::writeToBuffer(char * dataBuffer, size_t const bufferSize) const {
+  TaskProfileScope profile("CMatrix::writeToBuffer", n);
+  profile.addBytesSerialized(bufferSize);
+  bytesSerialized += bufferSize;
   if (bufferSize != getSize())
     throw std::runtime_error("Wrong buffer size to CMatrix::writeToBuffer.");
-  if(n <= BLOCK_SIZE) {
+  std::shared_ptr<std::vector<char> const> enc = getEncodedElements();
+  int encoding = enc ? LEAF_ENCODING_COMPRESSED : LEAF_ENCODING_RAW;
+  memcpy(dataBuffer, &n, sizeof(int));
+  memcpy(dataBuffer+sizeof(int), &blockSize, sizeof(int));
+  memcpy(dataBuffer+2*sizeof(int), &leafType, sizeof(int));
+  memcpy(dataBuffer+3*sizeof(int), &encoding, sizeof(int));
+  memcpy(dataBuffer+4*sizeof(int), &symmetric, sizeof(int));
+  memcpy(dataBuffer+5*sizeof(int), &norm, sizeof(double));
+  char* p = dataBuffer + HEADER_SIZE;
+  if(isLeaf()) {
     // Lowest level
-    memcpy(dataBuffer, &n, sizeof(int));
-    memcpy(dataBuffer+sizeof(int), &elements[0], n*n*sizeof(double));
+    if(enc)
+      memcpy(p, &(*enc)[0], enc->size());
+    else
+      memcpy(p, &elements[0], leafElementBytes());
   }
   else {
     // Not lowest level
-    memcpy(dataBuffer, &n, sizeof(int));
-    memcpy(dataBuffer+sizeof(int), &children[0], 4*sizeof(cht::ChunkID));
+    memcpy(p, &children[0], 4*sizeof(cht::ChunkID));
+    memcpy(p+4*sizeof(cht::ChunkID), &childNorms[0], 4*sizeof(double));
   }
 }
 size_t CMatrix::getSize() const {
-  if(n <= BLOCK_SIZE) {
+  if(isLeaf()) {
     // Lowest level
-    return sizeof(int) + n*n*sizeof(double);
+    std::shared_ptr<std::vector<char> const> enc = getEncodedElements();
+    return HEADER_SIZE + (enc ? enc->size() : leafElementBytes());
   }
   else {
     // Not lowest level
-    return sizeof(int) + 4*sizeof(cht::ChunkID);
+    return HEADER_SIZE + CHILDREN_SIZE;
   }
 }
 void CMatrix::assignFromBuffer(char const * dataBuffer, size_t const bufferSize) {
-  if (bufferSize < sizeof(int))
+  TaskProfileScope profile("CMatrix::assignFromBuffer", 0);
+  profile.addBytesDeserialized(bufferSize);
+  if (bufferSize < HEADER_SIZE)
     throw std::runtime_error("Wrong buffer size to CMatrix::assign_from_buffer.");
+  int encoding;
   memcpy(&n, dataBuffer, sizeof(int));
-  if(n <= BLOCK_SIZE) {
+  memcpy(&blockSize, dataBuffer+sizeof(int), sizeof(int));
+  memcpy(&leafType, dataBuffer+2*sizeof(int), sizeof(int));
+  memcpy(&encoding, dataBuffer+3*sizeof(int), sizeof(int));
+  memcpy(&symmetric, dataBuffer+4*sizeof(int), sizeof(int));
+  memcpy(&norm, dataBuffer+5*sizeof(int), sizeof(double));
+  if(encoding != LEAF_ENCODING_RAW && encoding != LEAF_ENCODING_COMPRESSED)
+    throw std::runtime_error("Unknown leaf encoding in CMatrix::assign_from_buffer.");
+  profile.setSize(n);
+  char const * p = dataBuffer + HEADER_SIZE;
+  if(isLeaf()) {
     // Lowest level
-    if(bufferSize != sizeof(int) + n*n*sizeof(double))
+    if(encoding == LEAF_ENCODING_RAW && bufferSize != HEADER_SIZE + leafElementBytes())
       throw std::runtime_error("Wrong buffer size to CMatrix::assign_from_buffer.");
-    elements.resize(n*n);
-    memcpy(&elements[0], dataBuffer+sizeof(int), n*n*sizeof(double));
+    // resize() takes an aligned block from the leaf memory pool
+    // without initializing it, so the elements are written only once.
+    elements.resize(hasFloatElements() ? (n*n+1)/2 : n*n);
+    if(encoding == LEAF_ENCODING_COMPRESSED)
+      leaf_codec_decode(p, bufferSize - HEADER_SIZE, hasFloatElements() ? sizeof(float) : sizeof(double),
+			(char*)&elements[0], leafElementBytes());
+    else
+      memcpy(&elements[0], p, leafElementBytes());
   }
   else {
     // Not lowest level
-    if(bufferSize != sizeof(int) + 4*sizeof(cht::ChunkID))
+    if(bufferSize != HEADER_SIZE + CHILDREN_SIZE)
       throw std::runtime_error("Wrong buffer size to CMatrix::assign_from_buffer.");
-    memcpy(&children, dataBuffer+sizeof(int), 4*sizeof(cht::ChunkID));
+    memcpy(&children, p, 4*sizeof(cht::ChunkID));
+    memcpy(&childNorms, p+4*sizeof(cht::ChunkID), 4*sizeof(double));
   }
 }
 size_t CMatrix::memoryUsage() const {
-  return getSize();
+  if(!isLeaf())
+    return HEADER_SIZE + CHILDREN_SIZE;
+  // The encoded copy is counted only if it exists, asking does not encode the leaf
+  size_t encodedBytes = encodedDone.load(std::memory_order_acquire) && encoded ? encoded->size() : 0;
+  return HEADER_SIZE + leafElementBytes() + encodedBytes;
 }
 void CMatrix::getChildChunks(std::list<cht::ChunkID> & childChunkIDs) const {
   if(elements.size() != 0) {
     // Lowest level. Nothing to do in this case.
   }
   else {
-    // Not lowest level
+    // Not lowest level. CHUNK_ID_NULL children are zero matrices that are not stored.
     for(int i = 0; i < 4; i++)
-      childChunkIDs.push_back(children[i]);
+      if(children[i] != cht::CHUNK_ID_NULL)
+	childChunkIDs.push_back(children[i]);
+  }
+}
+double const * CMatrix::getDoubleElements(LeafBuffer & tmp) const {
+  if(!hasFloatElements())
+    return elements.data();
+  tmp.resize(n*n);
+  float const * src = floatElements();
+  for(int i = 0; i < n*n; i++)
+    tmp[i] = src[i];
+  return tmp.data();
+}
+void CMatrix::setLeafType(int newLeafType) {
+  if(hasFloatElements())
+    throw std::runtime_error("Error in CMatrix::setLeafType: elements are already converted.");
+  if(newLeafType != LEAF_DOUBLE) {
+    LeafBuffer packed;
+    packed.resize((n*n+1)/2);
+    float* dst = (float*)packed.data();
+    for(int i = 0; i < n*n; i++)
+      dst[i] = (float)elements[i];
+    elements.swap(packed);
+  }
+  leafType = newLeafType;
+}
+void CMatrix::setNormFromElements() {
+  double sum = 0;
+  if(hasFloatElements()) {
+    float const * x = floatElements();
+    for(int i = 0; i < n*n; i++)
+      sum += (double)x[i]*x[i];
   }
+  else {
+    for(int i = 0; i < n*n; i++)
+      sum += elements[i]*elements[i];
+  }
+  norm = std::sqrt(sum);
+}
+void CMatrix::setNormFromChildNorms() {
+  double sum = 0;
+  for(int i = 0; i < 4; i++) {
+    if(childNorms[i] < 0) {
+      norm = -1;
+      return;
+    }
+    sum += childNorms[i]*childNorms[i];
+  }
+  norm = std::sqrt(sum);
+}
+void CMatrix::setNormsUnknown() {
+  norm = -1;
+  for(int i = 0; i < 4; i++)
+    childNorms[i] = -1;
+}
+size_t CMatrix::getBytesSerialized() {
+  return bytesSerialized.load();
+}
+void CMatrix::resetBytesSerialized() {
+  bytesSerialized.store(0);
+}
+std::shared_ptr<std::vector<char> const> CMatrix::getEncodedElements() const {
+  if(!isLeaf() || !leaf_codec_enabled())
+    return std::shared_ptr<std::vector<char> const>();
+  // Other threads asking for the same leaf wait for the first one
+  std::call_once(encodedOnce, [this]() {
+      std::shared_ptr<std::vector<char> > enc(new std::vector<char>());
+      leaf_codec_encode((char const *)&elements[0], leafElementBytes(),
+			hasFloatElements() ? sizeof(float) : sizeof(double), *enc);
+      // Incompressible leaves are sent as they are
+      if(enc->size() < leafElementBytes())
+	encoded = enc;
+      encodedDone.store(true, std::memory_order_release);
+    });
+  return encoded;
 }
@@ -1,7 +1,12 @@
 #ifndef CMATRIX_HEADER
 #define CMATRIX_HEADER
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "chunks_and_tasks.h"
+#include "LeafMemory.h"
 struct CMatrix: public cht::Chunk {
   // Functions required for a Chunk
   void writeToBuffer(char * dataBuffer, size_t const bufferSize) const;
@@ -10,12 +15,65 @@ struct CMatrix: public cht::Chunk {
   void getChildChunks(std::list<cht::ChunkID> & childChunkIDs) const;
   size_t memoryUsage() const;
   // CMatrix specific functionality
-  static const int BLOCK_SIZE = 1000;
+  static const int DEFAULT_BLOCK_SIZE = 1000;
   static const int USE_BLAS = 1;
-  CMatrix() { }
+  // Leaf element storage types
+  static const int LEAF_DOUBLE = 0; // double precision
+  static const int LEAF_FLOAT = 1; // stored as float, computed in double precision
+  static const int LEAF_FLOAT_SGEMM = 2; // stored as float, multiplied with sgemm
+  // Serialized leaf element encodings, see LeafCodec.h
+  static const int LEAF_ENCODING_RAW = 0;
+  static const int LEAF_ENCODING_COMPRESSED = 1;
+  CMatrix() : leafType(LEAF_DOUBLE), symmetric(0), norm(0), encodedDone(false) { }
+  bool isLeaf() const { return n <= blockSize; }
+  bool hasFloatElements() const { return leafType != LEAF_DOUBLE; }
+  size_t leafElementBytes() const { return hasFloatElements() ? n*n*sizeof(float) : n*n*sizeof(double); }
+  float* floatElements() { return (float*)elements.data(); }
+  float const * floatElements() const { return (float const *)elements.data(); }
+  // Leaf elements as doubles, float elements are converted into tmp
+  double const * getDoubleElements(LeafBuffer & tmp) const;
+  // Converts n*n double leaf elements to the storage given by newLeafType
+  void setLeafType(int newLeafType);
+  // Sets norm from the leaf elements, called when a leaf is created
+  void setNormFromElements();
+  // Sets norm from childNorms, called when a non-leaf is created. Unknown if a child norm is.
+  void setNormFromChildNorms();
+  // Marks norm and childNorms as unknown, for non-leaves created without fetching the children
+  void setNormsUnknown();
+  /* Whether norm and childNorms are known. Leaves always know their
+     norm. Non-leaves only if they were created with norms, i.e. from
+     CreateMatrix or LoadMatrix asked for them, or by tasks whose
+     inputs had them, so the children are only fetched for their norms
+     when the matrices are to be screened. */
+  bool hasNorms() const { return norm >= 0; }
+  // Bytes written by writeToBuffer in this process, i.e. sent or cached
+  static size_t getBytesSerialized();
+  static void resetBytesSerialized();
   int n; // matrix dimension
-  std::vector<double> elements; // matrix elements, if lowest level
-  cht::ChunkID children[4]; // 2x2 matrix of ids for child matrices, if not lowest level
+  int blockSize; // leaf matrix dimension, same for all chunks in a quad-tree
+  int leafType; // one of the LEAF_* values, only used for leaves
+  /* 1 for a symmetric matrix stored as its upper block triangle:
+     children[2] is CHUNK_ID_NULL and stands for children[1]^T,
+     children[0] and children[3] are symmetric. Symmetric leaves store
+     all elements. Only the symmetric tasks (MatrixSquareSymm,
+     MatrixSyrk, MatrixMultiplySymm), MatrixAdd, MatrixSubtract,
+     MatrixScale, MatrixNegate, GetMatrixElement and
+     MatrixVectorMultiply handle symmetric matrices, the other
+     multiplies throw. */
+  int symmetric;
+  double norm; // Frobenius norm, used by MatrixMultiply to screen small products, -1 if unknown
+  LeafBuffer elements; // matrix elements, if lowest level, 64-byte aligned. Float elements are packed, two per double.
+  cht::ChunkID children[4]; // 2x2 matrix of ids for child matrices, if not lowest level. CHUNK_ID_NULL means all-zero child matrix.
+  double childNorms[4]; // Frobenius norms of the children, if not lowest level, so that they can be screened without fetching them, -1 if unknown
+  /* Leaf elements encoded with the leaf codec if LEAF_COMPRESSION is
+     set and the encoding is smaller, otherwise null. Encoded once, by
+     the first call, and then kept, so the elements must not be changed
+     after that, which holds for registered chunks. */
+  std::shared_ptr<std::vector<char> const> getEncodedElements() const;
+ private:
+  mutable std::once_flag encodedOnce;
+  mutable std::atomic<bool> encodedDone; // set when encoded has its final value
+  mutable std::shared_ptr<std::vector<char> const> encoded;
   CHT_CHUNK_TYPE_DECLARATION;
 };
 
@@ -0,0 +1,28 @@
+#include <cstring>
+#include "CMatrixFile.h"
+
+static const size_t FIXED_SIZE = sizeof(MatrixFileHeader) + 2*sizeof(int);
+
+CHT_CHUNK_TYPE_IMPLEMENTATION((CMatrixFile));
+void CMatrixFile::writeToBuffer(char * dataBuffer, size_t const bufferSize) const {
+  if (bufferSize != getSize())
+    throw std::runtime_error("Wrong buffer size to CMatrixFile::writeToBuffer.");
+  memcpy(dataBuffer, &header, sizeof(MatrixFileHeader));
+  memcpy(dataBuffer+sizeof(MatrixFileHeader), &verifyChecksums, sizeof(int));
+  memcpy(dataBuffer+sizeof(MatrixFileHeader)+sizeof(int), &withNorms, sizeof(int));
+  memcpy(dataBuffer+FIXED_SIZE, path.data(), path.size());
+}
+size_t CMatrixFile::getSize() const {
+  return FIXED_SIZE + path.size();
+}
+void CMatrixFile::assignFromBuffer(char const * dataBuffer, size_t const bufferSize) {
+  if (bufferSize < FIXED_SIZE)
+    throw std::runtime_error("Wrong buffer size to CMatrixFile::assign_from_buffer.");
+  memcpy(&header, dataBuffer, sizeof(MatrixFileHeader));
+  memcpy(&verifyChecksums, dataBuffer+sizeof(MatrixFileHeader), sizeof(int));
+  memcpy(&withNorms, dataBuffer+sizeof(MatrixFileHeader)+sizeof(int), sizeof(int));
+  path.assign(dataBuffer+FIXED_SIZE, bufferSize-FIXED_SIZE);
+}
+size_t CMatrixFile::memoryUsage() const {
+  return getSize();
+}
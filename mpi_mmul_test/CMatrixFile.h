@@ -0,0 +1,25 @@
+#ifndef CMATRIXFILE_HEADER
+#define CMATRIXFILE_HEADER
+
+#include <string>
+#include "chunks_and_tasks.h"
+#include "MatrixFile.h"
+/* A matrix file for SaveMatrix and LoadMatrix, see MatrixFile.h. The
+   file must be reachable under the same path from all processes, e.g.
+   on a shared file system or on the local disk of a single node. */
+struct CMatrixFile: public cht::Chunk {
+  // Functions required for a Chunk
+  void writeToBuffer(char * dataBuffer, size_t const bufferSize) const;
+  size_t getSize() const;
+  void assignFromBuffer(char const * dataBuffer, size_t const bufferSize);
+  size_t memoryUsage() const;
+  // CMatrixFile specific functionality
+  CMatrixFile() : verifyChecksums(0), withNorms(0) { }
+  MatrixFileHeader header;
+  int verifyChecksums; // 1 if LoadMatrix checks each leaf against its checksum
+  int withNorms; // 1 if LoadMatrix gives the non-leaf nodes their norms, see CMatrix::hasNorms
+  std::string path;
+  CHT_CHUNK_TYPE_DECLARATION;
+};
+
+#endif
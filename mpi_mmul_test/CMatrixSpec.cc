@@ -0,0 +1,32 @@
+#include <cstring>
+#include "CMatrixSpec.h"
+
+static const int N_SPEC_VALUES = 8;
+
+CHT_CHUNK_TYPE_IMPLEMENTATION((CMatrixSpec));
+void CMatrixSpec::writeToBuffer(char * dataBuffer, size_t const bufferSize) const {
+  if (bufferSize != getSize())
+    throw std::runtime_error("Wrong buffer size to CMatrixSpec::writeToBuffer.");
+  int values[N_SPEC_VALUES] = {N, blockSize, matType, patternType, patternParam, leafType, symmetric, withNorms};
+  memcpy(dataBuffer, values, sizeof(values));
+}
+size_t CMatrixSpec::getSize() const {
+  return N_SPEC_VALUES*sizeof(int);
+}
+void CMatrixSpec::assignFromBuffer(char const * dataBuffer, size_t const bufferSize) {
+  if (bufferSize != getSize())
+    throw std::runtime_error("Wrong buffer size to CMatrixSpec::assign_from_buffer.");
+  int values[N_SPEC_VALUES];
+  memcpy(values, dataBuffer, sizeof(values));
+  N            = values[0];
+  blockSize    = values[1];
+  matType      = values[2];
+  patternType  = values[3];
+  patternParam = values[4];
+  leafType     = values[5];
+  symmetric    = values[6];
+  withNorms    = values[7];
+}
+size_t CMatrixSpec::memoryUsage() const {
+  return getSize();
+}
@@ -0,0 +1,27 @@
+#ifndef CMATRIXSPEC_HEADER
+#define CMATRIXSPEC_HEADER
+
+#include "chunks_and_tasks.h"
+/* Description of a test matrix to be created by CreateMatrix: which
+   element function and sparsity pattern to use, the logical matrix
+   size and the leaf block size. */
+struct CMatrixSpec: public cht::Chunk {
+  // Functions required for a Chunk
+  void writeToBuffer(char * dataBuffer, size_t const bufferSize) const;
+  size_t getSize() const;
+  void assignFromBuffer(char const * dataBuffer, size_t const bufferSize);
+  size_t memoryUsage() const;
+  // CMatrixSpec specific functionality
+  CMatrixSpec() : symmetric(0), withNorms(0) { }
+  int N; // logical matrix dimension, elements outside are zero padding
+  int blockSize; // leaf matrix dimension
+  int matType; // one of the MATRIX_TYPE_* values
+  int patternType; // one of the SPARSITY_PATTERN_* values
+  int patternParam;
+  int leafType; // one of the CMatrix::LEAF_* values
+  int symmetric; // 1 for the symmetric part of the element function, stored as upper block triangle
+  int withNorms; // 1 if the non-leaf nodes store the norms of their children, needed for screening
+  CHT_CHUNK_TYPE_DECLARATION;
+};
+
+#endif
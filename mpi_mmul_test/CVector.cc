@@ -0,0 +1,63 @@
+#include <cstring>
+#include "CVector.h"
+
+CHT_CHUNK_TYPE_IMPLEMENTATION((CVector));
+void CVector::writeToBuffer(char * dataBuffer, size_t const bufferSize) const {
+  if (bufferSize != getSize())
+    throw std::runtime_error("Wrong buffer size to CVector::writeToBuffer.");
+  memcpy(dataBuffer, &n, sizeof(int));
+  memcpy(dataBuffer+sizeof(int), &blockSize, sizeof(int));
+  char* p = dataBuffer + 2*sizeof(int);
+  if(isLeaf()) {
+    // Lowest level
+    memcpy(p, &elements[0], n*sizeof(double));
+  }
+  else {
+    // Not lowest level
+    memcpy(p, &children[0], 2*sizeof(cht::ChunkID));
+  }
+}
+size_t CVector::getSize() const {
+  if(isLeaf()) {
+    // Lowest level
+    return 2*sizeof(int) + n*sizeof(double);
+  }
+  else {
+    // Not lowest level
+    return 2*sizeof(int) + 2*sizeof(cht::ChunkID);
+  }
+}
+void CVector::assignFromBuffer(char const * dataBuffer, size_t const bufferSize) {
+  if (bufferSize < 2*sizeof(int))
+    throw std::runtime_error("Wrong buffer size to CVector::assign_from_buffer.");
+  memcpy(&n, dataBuffer, sizeof(int));
+  memcpy(&blockSize, dataBuffer+sizeof(int), sizeof(int));
+  char const * p = dataBuffer + 2*sizeof(int);
+  if(isLeaf()) {
+    // Lowest level
+    if(bufferSize != 2*sizeof(int) + n*sizeof(double))
+      throw std::runtime_error("Wrong buffer size to CVector::assign_from_buffer.");
+    elements.resize(n);
+    memcpy(&elements[0], p, n*sizeof(double));
+  }
+  else {
+    // Not lowest level
+    if(bufferSize != 2*sizeof(int) + 2*sizeof(cht::ChunkID))
+      throw std::runtime_error("Wrong buffer size to CVector::assign_from_buffer.");
+    memcpy(&children, p, 2*sizeof(cht::ChunkID));
+  }
+}
+size_t CVector::memoryUsage() const {
+  return getSize();
+}
+void CVector::getChildChunks(std::list<cht::ChunkID> & childChunkIDs) const {
+  if(isLeaf()) {
+    // Lowest level. Nothing to do in this case.
+  }
+  else {
+    // Not lowest level. CHUNK_ID_NULL children are zero vectors that are not stored.
+    for(int i = 0; i < 2; i++)
+      if(children[i] != cht::CHUNK_ID_NULL)
+	childChunkIDs.push_back(children[i]);
+  }
+}
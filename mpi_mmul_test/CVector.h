@@ -0,0 +1,26 @@
+#ifndef CVECTOR_HEADER
+#define CVECTOR_HEADER
+
+#include <vector>
+#include "chunks_and_tasks.h"
+/* Vector stored as a binary tree matching the CMatrix quad-tree: a
+   vector of length n has two children of length n/2, down to leaves
+   of length at most blockSize. Used by MatrixVectorMultiply. */
+struct CVector: public cht::Chunk {
+  // Functions required for a Chunk
+  void writeToBuffer(char * dataBuffer, size_t const bufferSize) const;
+  size_t getSize() const;
+  void assignFromBuffer(char const * dataBuffer, size_t const bufferSize);
+  void getChildChunks(std::list<cht::ChunkID> & childChunkIDs) const;
+  size_t memoryUsage() const;
+  // CVector specific functionality
+  CVector() { }
+  bool isLeaf() const { return n <= blockSize; }
+  int n; // vector length
+  int blockSize; // leaf vector length, same for all chunks in a tree
+  std::vector<double> elements; // vector elements, if lowest level
+  cht::ChunkID children[2]; // ids for upper and lower half, if not lowest level. CHUNK_ID_NULL means all-zero child vector.
+  CHT_CHUNK_TYPE_DECLARATION;
+};
+
+#endif
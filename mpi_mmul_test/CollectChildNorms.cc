@@ -0,0 +1,16 @@
+#include "CollectChildNorms.h"
+#include "TaskProfile.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((CollectChildNorms));
+cht::ID CollectChildNorms::execute(CDouble const & norm1, CDouble const & norm2, CDouble const & norm3, CDouble const & norm4) {
+  TaskProfileScope profile("CollectChildNorms", 0);
+  CVector* v = new CVector();
+  v->n = 4;
+  v->blockSize = 4;
+  v->elements.resize(4);
+  v->elements[0] = norm1;
+  v->elements[1] = norm2;
+  v->elements[2] = norm3;
+  v->elements[3] = norm4;
+  return registerChunk(v, cht::persistent);
+} // end execute
@@ -0,0 +1,12 @@
+#include "chunks_and_tasks.h"
+#include "CDouble.h"
+#include "CVector.h"
+
+/* Puts the norms of the 4 children of a quad-tree node into a CVector
+   leaf of length 4, as input to CreateMatrixFromIdsAndNorms. */
+struct CollectChildNorms: public cht::Task {
+  cht::ID execute(CDouble const &, CDouble const &, CDouble const &, CDouble const &);
+  CHT_TASK_INPUT((CDouble, CDouble, CDouble, CDouble));
+  CHT_TASK_OUTPUT((CVector));
+  CHT_TASK_TYPE_DECLARATION;
+};
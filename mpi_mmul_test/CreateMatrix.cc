@@ -1,25 +1,51 @@
 #include "CreateMatrix.h"
+#include "TaskProfile.h"
 #include "CreateMatrixFromIds.h"
+#include "CreateSymmMatrixFromIds.h"
+#include "CreateMatrixFromIdsWithNorms.h"
+#include "CreateSymmMatrixFromIdsWithNorms.h"
 #include "MatrixElementValues.h"
+#include "MatrixSparsityPattern.h"
 #include <cmath>
 
 CHT_TASK_TYPE_IMPLEMENTATION((CreateMatrix));
 cht::ID CreateMatrix::execute(CInt const & matSize,
 			      CInt const & baseIdx1,
 			      CInt const & baseIdx2,
-			      CInt const & matType) {
+			      CMatrixSpec const & spec) {
+  TaskProfileScope profile("CreateMatrix", matSize);
   int n = matSize;
-  if(n <= CMatrix::BLOCK_SIZE) {
+  int blockSize = spec.blockSize;
+  // Parts outside the logical N x N matrix are zero padding
+  if(baseIdx1 >= spec.N || baseIdx2 >= spec.N)
+    return cht::CHUNK_ID_NULL;
+  // Diagonal blocks of symmetric matrices are symmetric, the others are general
+  bool symmetric = spec.symmetric && baseIdx1 == baseIdx2;
+  int nBlocks = (n + blockSize - 1) / blockSize;
+  int blockIdx1 = baseIdx1 / blockSize;
+  int blockIdx2 = baseIdx2 / blockSize;
+  if(!blockRegionIsNonZero(spec.patternType, spec.patternParam, blockIdx1, blockIdx2, nBlocks)) {
+    // All-zero matrix, nothing is stored
+    return cht::CHUNK_ID_NULL;
+  }
+  if(n <= blockSize) {
     // Lowest level
     CMatrix* A = new CMatrix();
     A->n = n;
+    A->blockSize = blockSize;
     A->elements.resize(n*n);
     for(int i = 0; i < n; i++)
       for(int j = 0; j < n; j++) {
 	int idx1 = baseIdx1 + i;
 	int idx2 = baseIdx2 + j;
-	A->elements[i*matSize+j] = matElementFunc(matType, idx1, idx2);
+	if(idx1 < spec.N && idx2 < spec.N)
+	  A->elements[i*n+j] = spec.symmetric ? symmMatElementFunc(spec.matType, idx1, idx2) : matElementFunc(spec.matType, idx1, idx2);
+	else
+	  A->elements[i*n+j] = 0;
       }
+    A->symmetric = symmetric;
+    A->setLeafType(spec.leafType);
+    A->setNormFromElements();
     return registerChunk(A, cht::persistent);
   }
   else {
@@ -27,15 +53,31 @@ cht::ID CreateMatrix::execute(CInt const & matSize,
     if(matSize % 2 != 0)
       throw std::runtime_error("Error in CreateMatrix::execute: matSize not divisible by 2.");
     int nHalf = matSize / 2;
+    int nBlocksHalf = nBlocks / 2;
     cht::ChunkID cid_nHalf = registerChunk( new CInt(nHalf) );
     cht::ID childTaskIDs[4];
     for(int i1 = 0; i1 < 2; i1++) {
       cht::ChunkID cid_baseIdx_i1 = registerChunk( new CInt(baseIdx1+i1*nHalf) );
       for(int i2 = 0; i2 < 2; i2++) {
+	// Zero sub-matrices, including pure padding, are represented by
+	// CHUNK_ID_NULL, and so is the lower block of a symmetric matrix
+	if((symmetric && i1 > i2) || baseIdx1+i1*nHalf >= spec.N || baseIdx2+i2*nHalf >= spec.N ||
+	   !blockRegionIsNonZero(spec.patternType, spec.patternParam, blockIdx1+i1*nBlocksHalf, blockIdx2+i2*nBlocksHalf, nBlocksHalf)) {
+	  childTaskIDs[i1*2+i2] = cht::CHUNK_ID_NULL;
+	  continue;
+	}
 	cht::ChunkID cid_baseIdx_i2 = registerChunk( new CInt(baseIdx2+i2*nHalf) );
-	childTaskIDs[i1*2+i2] = registerTask<CreateMatrix>(cid_nHalf, cid_baseIdx_i1, cid_baseIdx_i2, getInputChunkID(matType));
+	childTaskIDs[i1*2+i2] = registerTask<CreateMatrix>(cid_nHalf, cid_baseIdx_i1, cid_baseIdx_i2, getInputChunkID(spec));
       }
     }
-    return registerTask<CreateMatrixFromIds>(getInputChunkID(matSize), childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(blockSize) );
+    if(spec.withNorms) {
+      if(symmetric)
+	return registerTask<CreateSymmMatrixFromIdsWithNorms>(getInputChunkID(matSize), cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+      return registerTask<CreateMatrixFromIdsWithNorms>(getInputChunkID(matSize), cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+    }
+    if(symmetric)
+      return registerTask<CreateSymmMatrixFromIds>(getInputChunkID(matSize), cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+    return registerTask<CreateMatrixFromIds>(getInputChunkID(matSize), cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
   }
 } // end execute
@@ -1,12 +1,23 @@
 #include "CreateMatrixFromIds.h"
+#include "TaskProfile.h"
 
 CHT_TASK_TYPE_IMPLEMENTATION((CreateMatrixFromIds));
-cht::ID CreateMatrixFromIds::execute(CInt const & n, cht::ChunkID const & id1, cht::ChunkID const & id2, cht::ChunkID const & id3, cht::ChunkID const & id4) {
+cht::ID CreateMatrixFromIds::execute(CInt const & n, CInt const & blockSize, cht::ChunkID const & id1, cht::ChunkID const & id2, cht::ChunkID const & id3, cht::ChunkID const & id4) {
+  TaskProfileScope profile("CreateMatrixFromIds", n);
+  cht::ChunkID const * ids[4] = {&id1, &id2, &id3, &id4};
+  // If all children are zero the whole matrix is zero
+  if(id1 == cht::CHUNK_ID_NULL && id2 == cht::CHUNK_ID_NULL &&
+     id3 == cht::CHUNK_ID_NULL && id4 == cht::CHUNK_ID_NULL)
+    return cht::CHUNK_ID_NULL;
   CMatrix* A = new CMatrix();
   A->n = n;
-  A->children[0] = copyChunk(id1);
-  A->children[1] = copyChunk(id2);
-  A->children[2] = copyChunk(id3);
-  A->children[3] = copyChunk(id4);
+  A->blockSize = blockSize;
+  for(int i = 0; i < 4; i++) {
+    if(*ids[i] == cht::CHUNK_ID_NULL)
+      A->children[i] = cht::CHUNK_ID_NULL;
+    else
+      A->children[i] = copyChunk(*ids[i]);
+  }
+  A->setNormsUnknown();
   return registerChunk(A, cht::persistent);
 }
@@ -2,9 +2,13 @@
 #include "CMatrix.h"
 #include "CInt.h"
 
+/* Creates a non-leaf matrix from the ids of its 4 children, where
+   CHUNK_ID_NULL means a zero child. The children are not fetched, so
+   the norms are left unknown, see CMatrix::hasNorms and
+   CreateMatrixFromIdsWithNorms. */
 struct CreateMatrixFromIds: public cht::Task {
-  cht::ID execute(CInt const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &);
-  CHT_TASK_INPUT((CInt, cht::ChunkID, cht::ChunkID, cht::ChunkID, cht::ChunkID));
+  cht::ID execute(CInt const &, CInt const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((CInt, CInt, cht::ChunkID, cht::ChunkID, cht::ChunkID, cht::ChunkID));
   CHT_TASK_OUTPUT((CMatrix));
   CHT_TASK_TYPE_DECLARATION;
 };
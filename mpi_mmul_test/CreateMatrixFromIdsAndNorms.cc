@@ -0,0 +1,21 @@
+#include "CreateMatrixFromIdsAndNorms.h"
+#include "TaskProfile.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((CreateMatrixFromIdsAndNorms));
+cht::ID CreateMatrixFromIdsAndNorms::execute(CInt const & n, CInt const & blockSize, CVector const & childNorms,
+					     cht::ChunkID const & id1, cht::ChunkID const & id2, cht::ChunkID const & id3, cht::ChunkID const & id4) {
+  TaskProfileScope profile("CreateMatrixFromIdsAndNorms", n);
+  cht::ChunkID const * ids[4] = {&id1, &id2, &id3, &id4};
+  CMatrix* A = new CMatrix();
+  A->n = n;
+  A->blockSize = blockSize;
+  for(int i = 0; i < 4; i++) {
+    if(*ids[i] == cht::CHUNK_ID_NULL)
+      A->children[i] = cht::CHUNK_ID_NULL;
+    else
+      A->children[i] = copyChunk(*ids[i]);
+    A->childNorms[i] = childNorms.elements[i];
+  }
+  A->setNormFromChildNorms();
+  return registerChunk(A, cht::persistent);
+}
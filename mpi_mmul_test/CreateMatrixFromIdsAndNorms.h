@@ -0,0 +1,14 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+#include "CInt.h"
+#include "CVector.h"
+
+/* Creates a non-leaf matrix with the given children, whose norms are
+   given in the CVector. Used by CreateMatrixFromIdsWithNorms, LoadMatrix,
+   MatrixScale and MatrixNegate. */
+struct CreateMatrixFromIdsAndNorms: public cht::Task {
+  cht::ID execute(CInt const &, CInt const &, CVector const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((CInt, CInt, CVector, cht::ChunkID, cht::ChunkID, cht::ChunkID, cht::ChunkID));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
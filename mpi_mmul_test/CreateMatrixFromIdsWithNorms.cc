@@ -0,0 +1,28 @@
+#include "CreateMatrixFromIdsWithNorms.h"
+#include "TaskProfile.h"
+#include "CDouble.h"
+#include "GetMatrixNorm.h"
+#include "CollectChildNorms.h"
+#include "CreateMatrixFromIdsAndNorms.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((CreateMatrixFromIdsWithNorms));
+cht::ID CreateMatrixFromIdsWithNorms::execute(CInt const & n, CInt const & blockSize, cht::ChunkID const & id1, cht::ChunkID const & id2, cht::ChunkID const & id3, cht::ChunkID const & id4) {
+  TaskProfileScope profile("CreateMatrixFromIdsWithNorms", n);
+  cht::ChunkID const * ids[4] = {&id1, &id2, &id3, &id4};
+  // If all children are zero the whole matrix is zero
+  if(id1 == cht::CHUNK_ID_NULL && id2 == cht::CHUNK_ID_NULL &&
+     id3 == cht::CHUNK_ID_NULL && id4 == cht::CHUNK_ID_NULL)
+    return cht::CHUNK_ID_NULL;
+  /* The children are only known by id here, so their norms are read
+     by GetMatrixNorm tasks. Zero children have norm 0. */
+  cht::ID normIDs[4];
+  for(int i = 0; i < 4; i++) {
+    if(*ids[i] == cht::CHUNK_ID_NULL)
+      normIDs[i] = registerChunk( new CDouble(0) );
+    else
+      normIDs[i] = registerTask<GetMatrixNorm>(*ids[i]);
+  }
+  cht::ID cid_childNorms = registerTask<CollectChildNorms>(normIDs[0], normIDs[1], normIDs[2], normIDs[3]);
+  return registerTask<CreateMatrixFromIdsAndNorms>(getInputChunkID(n), getInputChunkID(blockSize), cid_childNorms,
+						   id1, id2, id3, id4, cht::persistent);
+}
@@ -0,0 +1,14 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+#include "CInt.h"
+
+/* Like CreateMatrixFromIds, but the norms of the children are read by
+   GetMatrixNorm tasks and stored, see CreateMatrixFromIdsAndNorms.
+   This fetches every child, so it is only used for matrices that are
+   to be screened, see CMatrix::hasNorms. */
+struct CreateMatrixFromIdsWithNorms: public cht::Task {
+  cht::ID execute(CInt const &, CInt const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((CInt, CInt, cht::ChunkID, cht::ChunkID, cht::ChunkID, cht::ChunkID));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
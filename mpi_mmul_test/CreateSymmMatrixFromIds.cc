@@ -0,0 +1,25 @@
+#include "CreateSymmMatrixFromIds.h"
+#include "TaskProfile.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((CreateSymmMatrixFromIds));
+cht::ID CreateSymmMatrixFromIds::execute(CInt const & n, CInt const & blockSize, cht::ChunkID const & id11, cht::ChunkID const & id12, cht::ChunkID const & id22) {
+  TaskProfileScope profile("CreateSymmMatrixFromIds", n);
+  // If all children are zero the whole matrix is zero
+  if(id11 == cht::CHUNK_ID_NULL && id12 == cht::CHUNK_ID_NULL && id22 == cht::CHUNK_ID_NULL)
+    return cht::CHUNK_ID_NULL;
+  // A21 is not stored
+  cht::ChunkID const id21 = cht::CHUNK_ID_NULL;
+  cht::ChunkID const * ids[4] = {&id11, &id12, &id21, &id22};
+  CMatrix* A = new CMatrix();
+  A->n = n;
+  A->blockSize = blockSize;
+  A->symmetric = 1;
+  for(int i = 0; i < 4; i++) {
+    if(*ids[i] == cht::CHUNK_ID_NULL)
+      A->children[i] = cht::CHUNK_ID_NULL;
+    else
+      A->children[i] = copyChunk(*ids[i]);
+  }
+  A->setNormsUnknown();
+  return registerChunk(A, cht::persistent);
+}
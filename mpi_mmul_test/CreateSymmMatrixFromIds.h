@@ -0,0 +1,14 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+#include "CInt.h"
+
+/* Creates a non-leaf symmetric matrix from the ids of its upper block
+   triangle A11, A12 and A22, where A11 and A22 are symmetric and
+   CHUNK_ID_NULL means a zero block. Like CreateMatrixFromIds the
+   norms are left unknown. */
+struct CreateSymmMatrixFromIds: public cht::Task {
+  cht::ID execute(CInt const &, CInt const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((CInt, CInt, cht::ChunkID, cht::ChunkID, cht::ChunkID));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,24 @@
+#include "CreateSymmMatrixFromIdsAndNorms.h"
+#include "TaskProfile.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((CreateSymmMatrixFromIdsAndNorms));
+cht::ID CreateSymmMatrixFromIdsAndNorms::execute(CInt const & n, CInt const & blockSize, CVector const & childNorms,
+						 cht::ChunkID const & id11, cht::ChunkID const & id12, cht::ChunkID const & id22) {
+  TaskProfileScope profile("CreateSymmMatrixFromIdsAndNorms", n);
+  // A21 is not stored
+  cht::ChunkID const id21 = cht::CHUNK_ID_NULL;
+  cht::ChunkID const * ids[4] = {&id11, &id12, &id21, &id22};
+  CMatrix* A = new CMatrix();
+  A->n = n;
+  A->blockSize = blockSize;
+  A->symmetric = 1;
+  for(int i = 0; i < 4; i++) {
+    if(*ids[i] == cht::CHUNK_ID_NULL)
+      A->children[i] = cht::CHUNK_ID_NULL;
+    else
+      A->children[i] = copyChunk(*ids[i]);
+    A->childNorms[i] = childNorms.elements[i];
+  }
+  A->setNormFromChildNorms();
+  return registerChunk(A, cht::persistent);
+}
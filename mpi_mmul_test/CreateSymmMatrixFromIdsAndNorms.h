@@ -0,0 +1,15 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+#include "CInt.h"
+#include "CVector.h"
+
+/* Creates a non-leaf symmetric matrix with the given upper block
+   triangle, whose norms are given in the CVector (4 values, the
+   second and third both for A12). Used by
+   CreateSymmMatrixFromIdsWithNorms and LoadMatrix. */
+struct CreateSymmMatrixFromIdsAndNorms: public cht::Task {
+  cht::ID execute(CInt const &, CInt const &, CVector const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((CInt, CInt, CVector, cht::ChunkID, cht::ChunkID, cht::ChunkID));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
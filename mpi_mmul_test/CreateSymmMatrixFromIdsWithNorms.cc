@@ -0,0 +1,26 @@
+#include "CreateSymmMatrixFromIdsWithNorms.h"
+#include "TaskProfile.h"
+#include "CDouble.h"
+#include "GetMatrixNorm.h"
+#include "CollectChildNorms.h"
+#include "CreateSymmMatrixFromIdsAndNorms.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((CreateSymmMatrixFromIdsWithNorms));
+cht::ID CreateSymmMatrixFromIdsWithNorms::execute(CInt const & n, CInt const & blockSize, cht::ChunkID const & id11, cht::ChunkID const & id12, cht::ChunkID const & id22) {
+  TaskProfileScope profile("CreateSymmMatrixFromIdsWithNorms", n);
+  cht::ChunkID const * ids[3] = {&id11, &id12, &id22};
+  // If all children are zero the whole matrix is zero
+  if(id11 == cht::CHUNK_ID_NULL && id12 == cht::CHUNK_ID_NULL && id22 == cht::CHUNK_ID_NULL)
+    return cht::CHUNK_ID_NULL;
+  cht::ID normIDs[3];
+  for(int i = 0; i < 3; i++) {
+    if(*ids[i] == cht::CHUNK_ID_NULL)
+      normIDs[i] = registerChunk( new CDouble(0) );
+    else
+      normIDs[i] = registerTask<GetMatrixNorm>(*ids[i]);
+  }
+  // The lower block A21 = A12^T has the same norm as A12
+  cht::ID cid_childNorms = registerTask<CollectChildNorms>(normIDs[0], normIDs[1], normIDs[1], normIDs[2]);
+  return registerTask<CreateSymmMatrixFromIdsAndNorms>(getInputChunkID(n), getInputChunkID(blockSize), cid_childNorms,
+						       id11, id12, id22, cht::persistent);
+}
@@ -0,0 +1,13 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+#include "CInt.h"
+
+/* Like CreateSymmMatrixFromIds, but the norms of the children are
+   read by GetMatrixNorm tasks and stored, as in
+   CreateMatrixFromIdsWithNorms. */
+struct CreateSymmMatrixFromIdsWithNorms: public cht::Task {
+  cht::ID execute(CInt const &, CInt const &, cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((CInt, CInt, cht::ChunkID, cht::ChunkID, cht::ChunkID));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
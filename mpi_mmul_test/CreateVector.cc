@@ -0,0 +1,46 @@
+#include "CreateVector.h"
+#include "TaskProfile.h"
+#include "CreateVectorFromIds.h"
+#include "MatrixElementValues.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((CreateVector));
+cht::ID CreateVector::execute(CInt const & vecSize,
+			      CInt const & baseIdx,
+			      CInt const & N,
+			      CInt const & blockSize,
+			      CInt const & seed) {
+  TaskProfileScope profile("CreateVector", vecSize);
+  int n = vecSize;
+  // Parts outside the logical vector are zero padding
+  if(baseIdx >= N)
+    return cht::CHUNK_ID_NULL;
+  if(n <= blockSize) {
+    // Lowest level
+    CVector* x = new CVector();
+    x->n = n;
+    x->blockSize = blockSize;
+    x->elements.resize(n);
+    for(int i = 0; i < n; i++) {
+      int idx = baseIdx + i;
+      x->elements[i] = idx < N ? vectorElementFunc(seed, idx) : 0;
+    }
+    return registerChunk(x, cht::persistent);
+  }
+  else {
+    // Not lowest level
+    if(n % 2 != 0)
+      throw std::runtime_error("Error in CreateVector::execute: vecSize not divisible by 2.");
+    int nHalf = n / 2;
+    cht::ChunkID cid_nHalf = registerChunk( new CInt(nHalf) );
+    cht::ID childTaskIDs[2];
+    for(int i = 0; i < 2; i++) {
+      if(baseIdx+i*nHalf >= N) {
+	childTaskIDs[i] = cht::CHUNK_ID_NULL;
+	continue;
+      }
+      cht::ChunkID cid_baseIdx_i = registerChunk( new CInt(baseIdx+i*nHalf) );
+      childTaskIDs[i] = registerTask<CreateVector>(cid_nHalf, cid_baseIdx_i, getInputChunkID(N), getInputChunkID(blockSize), getInputChunkID(seed));
+    }
+    return registerTask<CreateVectorFromIds>(getInputChunkID(vecSize), getInputChunkID(blockSize), childTaskIDs[0], childTaskIDs[1], cht::persistent);
+  }
+} // end execute
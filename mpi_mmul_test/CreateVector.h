@@ -0,0 +1,14 @@
+#include "chunks_and_tasks.h"
+#include "CInt.h"
+#include "CVector.h"
+
+/* Creates a pseudo-random vector of length n starting at index
+   baseIdx, with inputs n, baseIdx, N, blockSize and seed. Elements
+   with index >= N are zero padding. The elements only depend on the
+   seed and the index, see vectorElementFunc. */
+struct CreateVector: public cht::Task {
+  cht::ID execute(CInt const &, CInt const &, CInt const &, CInt const &, CInt const &);
+  CHT_TASK_INPUT((CInt, CInt, CInt, CInt, CInt));
+  CHT_TASK_OUTPUT((CVector));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,21 @@
+#include "CreateVectorFromIds.h"
+#include "TaskProfile.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((CreateVectorFromIds));
+cht::ID CreateVectorFromIds::execute(CInt const & n, CInt const & blockSize, cht::ChunkID const & id1, cht::ChunkID const & id2) {
+  TaskProfileScope profile("CreateVectorFromIds", n);
+  cht::ChunkID const * ids[2] = {&id1, &id2};
+  // If both children are zero the whole vector is zero
+  if(id1 == cht::CHUNK_ID_NULL && id2 == cht::CHUNK_ID_NULL)
+    return cht::CHUNK_ID_NULL;
+  CVector* x = new CVector();
+  x->n = n;
+  x->blockSize = blockSize;
+  for(int i = 0; i < 2; i++) {
+    if(*ids[i] == cht::CHUNK_ID_NULL)
+      x->children[i] = cht::CHUNK_ID_NULL;
+    else
+      x->children[i] = copyChunk(*ids[i]);
+  }
+  return registerChunk(x, cht::persistent);
+}
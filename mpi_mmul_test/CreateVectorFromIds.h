@@ -0,0 +1,10 @@
+#include "chunks_and_tasks.h"
+#include "CVector.h"
+#include "CInt.h"
+
+struct CreateVectorFromIds: public cht::Task {
+  cht::ID execute(CInt const &, CInt const &, cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((CInt, CInt, cht::ChunkID, cht::ChunkID));
+  CHT_TASK_OUTPUT((CVector));
+  CHT_TASK_TYPE_DECLARATION;
+};
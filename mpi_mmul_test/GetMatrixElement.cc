@@ -1,11 +1,15 @@
 #include "GetMatrixElement.h"
+#include "TaskProfile.h"
+#include <algorithm>
 
 CHT_TASK_TYPE_IMPLEMENTATION((GetMatrixElement));
 cht::ID GetMatrixElement::execute(CMatrix const & A, CInt const & idx1, CInt const & idx2) {
+  TaskProfileScope profile("GetMatrixElement", A.n);
   int n = A.n;
-  if(n <= CMatrix::BLOCK_SIZE) {
+  if(A.isLeaf()) {
     // Lowest level
-    return registerChunk( new CDouble(A.elements[idx1*n+idx2]), cht::persistent);
+    double value = A.hasFloatElements() ? A.floatElements()[idx1*n+idx2] : A.elements[idx1*n+idx2];
+    return registerChunk( new CDouble(value), cht::persistent);
   }
   else {
     // Not lowest level
@@ -19,9 +23,18 @@ cht::ID GetMatrixElement::execute(CMatrix const & A, CInt const & idx1, CInt con
       childIdx2 = 1;
     int idx1_child = idx1 - childIdx1*nHalf;
     int idx2_child = idx2 - childIdx2*nHalf;
+    if(A.symmetric && childIdx1 > childIdx2) {
+      // The lower block is the transpose of the stored upper block
+      std::swap(childIdx1, childIdx2);
+      std::swap(idx1_child, idx2_child);
+    }
+    cht::ChunkID cid_child = A.children[childIdx1*2+childIdx2];
+    if(cid_child == cht::CHUNK_ID_NULL) {
+      // All-zero child matrix
+      return registerChunk( new CDouble(0), cht::persistent);
+    }
     cht::ChunkID cid_idx1_child = registerChunk( new CInt(idx1_child) );
     cht::ChunkID cid_idx2_child = registerChunk( new CInt(idx2_child) );
-    cht::ChunkID cid_child = A.children[childIdx1*2+childIdx2];
     return registerTask<GetMatrixElement>(cid_child, cid_idx1_child, cid_idx2_child, cht::persistent);
   }
 } // end execute
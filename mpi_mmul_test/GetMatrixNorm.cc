@@ -0,0 +1,8 @@
+#include "GetMatrixNorm.h"
+#include "TaskProfile.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((GetMatrixNorm));
+cht::ID GetMatrixNorm::execute(CMatrix const & A) {
+  TaskProfileScope profile("GetMatrixNorm", A.n);
+  return registerChunk( new CDouble(A.norm), cht::persistent);
+} // end execute
@@ -0,0 +1,11 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+#include "CDouble.h"
+
+// Returns the Frobenius norm stored in the matrix
+struct GetMatrixNorm: public cht::Task {
+  cht::ID execute(CMatrix const &);
+  CHT_TASK_INPUT((CMatrix));
+  CHT_TASK_OUTPUT((CDouble));
+  CHT_TASK_TYPE_DECLARATION;
+};
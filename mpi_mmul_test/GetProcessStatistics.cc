@@ -0,0 +1,59 @@
+#include "GetProcessStatistics.h"
+#include "TaskProfile.h"
+#include "MergeProcessStatistics.h"
+#include "LeafMemory.h"
+#include "CMatrix.h"
+#include "LeafCodec.h"
+#include "MatrixLeafKernels.h"
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+
+// Time each leaf task waits, long enough for idle workers to steal siblings
+static const int STEAL_WAIT_MILLISECONDS = 5;
+
+/* Host name hash and pid, unique among the processes of a run and
+   exactly representable as a double. */
+static double process_id() {
+  char host[256] = {0};
+  gethostname(host, sizeof(host)-1);
+  unsigned long long hash = 14695981039346656037ULL;
+  for(char const * c = host; *c; c++)
+    hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+  return (double)((hash % (1ULL << 30)) * (1ULL << 22) + (unsigned long long)getpid() % (1ULL << 22));
+}
+
+CHT_TASK_TYPE_IMPLEMENTATION((GetProcessStatistics));
+cht::ID GetProcessStatistics::execute(CInt const & nTasks, CInt const & reset) {
+  TaskProfileScope profile("GetProcessStatistics", 0);
+  if(nTasks > 1) {
+    cht::ChunkID cid_nTasks1 = registerChunk( new CInt(nTasks / 2) );
+    cht::ChunkID cid_nTasks2 = registerChunk( new CInt(nTasks - nTasks / 2) );
+    cht::ID stats1 = registerTask<GetProcessStatistics>(cid_nTasks1, getInputChunkID(reset));
+    cht::ID stats2 = registerTask<GetProcessStatistics>(cid_nTasks2, getInputChunkID(reset));
+    return registerTask<MergeProcessStatistics>(stats1, stats2, cht::persistent);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(STEAL_WAIT_MILLISECONDS));
+  CVector* v = new CVector();
+  v->n = 1 + PROCESS_STAT_COUNT;
+  v->blockSize = v->n;
+  v->elements.resize(v->n);
+  v->elements[0] = process_id();
+  v->elements[1+PROCESS_STAT_LEAF_MEMORY_PEAK] = leaf_memory_peak();
+  v->elements[1+PROCESS_STAT_BYTES_SERIALIZED] = CMatrix::getBytesSerialized();
+  LeafCodecStatistics codec = leaf_codec_statistics();
+  v->elements[1+PROCESS_STAT_CODEC_BYTES_ENCODED] = codec.bytesEncoded;
+  v->elements[1+PROCESS_STAT_CODEC_BYTES_ENCODED_OUT] = codec.bytesEncodedOut;
+  v->elements[1+PROCESS_STAT_CODEC_SECONDS_ENCODE] = codec.secondsEncode;
+  v->elements[1+PROCESS_STAT_CODEC_BYTES_DECODED] = codec.bytesDecoded;
+  v->elements[1+PROCESS_STAT_CODEC_SECONDS_DECODE] = codec.secondsDecode;
+  v->elements[1+PROCESS_STAT_LEAF_MULTIPLIES] = leaf_multiply_count();
+  v->elements[1+PROCESS_STAT_LEAF_MEMORY_PEAK_HELD] = leaf_memory_peak_held();
+  if(reset == 1) {
+    leaf_memory_reset_peak();
+    CMatrix::resetBytesSerialized();
+    leaf_codec_reset_statistics();
+    leaf_multiply_reset_count();
+  }
+  return registerChunk(v, cht::persistent);
+} // end execute
@@ -0,0 +1,32 @@
+#include "chunks_and_tasks.h"
+#include "CInt.h"
+#include "CVector.h"
+
+// Per-process statistics, in the order they are stored for each process
+const int PROCESS_STAT_LEAF_MEMORY_PEAK = 0; // peak leaf memory in use in bytes, see LeafMemory.h
+const int PROCESS_STAT_BYTES_SERIALIZED = 1; // CMatrix bytes serialized, see CMatrix::getBytesSerialized
+// Leaf codec statistics, see LeafCodecStatistics in LeafCodec.h
+const int PROCESS_STAT_CODEC_BYTES_ENCODED = 2;
+const int PROCESS_STAT_CODEC_BYTES_ENCODED_OUT = 3;
+const int PROCESS_STAT_CODEC_SECONDS_ENCODE = 4;
+const int PROCESS_STAT_CODEC_BYTES_DECODED = 5;
+const int PROCESS_STAT_CODEC_SECONDS_DECODE = 6;
+const int PROCESS_STAT_LEAF_MULTIPLIES = 7; // leaf products computed, see leaf_multiply_count
+const int PROCESS_STAT_LEAF_MEMORY_PEAK_HELD = 8; // as above, including pooled free blocks
+const int PROCESS_STAT_COUNT = 9;
+
+/* Gathers the statistics of the worker processes as a CVector leaf
+   with one row of 1 + PROCESS_STAT_COUNT values per process: a process
+   id followed by the statistics. Chunks and Tasks cannot place a task
+   on a given worker, so the first input gives a number of tasks to
+   spread in a binary tree; each one waits a moment so that idle
+   workers steal some of them. The caller should check that all
+   processes were reached. If the second input is 1 the statistics are
+   reset in each process reached, the peak to the current usage and
+   the counters to zero. */
+struct GetProcessStatistics: public cht::Task {
+  cht::ID execute(CInt const &, CInt const &);
+  CHT_TASK_INPUT((CInt, CInt));
+  CHT_TASK_OUTPUT((CVector));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,172 @@
+#include "LeafCodec.h"
+#include "bench_timing.h"
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Updated from several worker threads, times in nanoseconds
+static std::atomic<unsigned long long> statBytesEncoded(0);
+static std::atomic<unsigned long long> statBytesEncodedOut(0);
+static std::atomic<unsigned long long> statNanosecondsEncode(0);
+static std::atomic<unsigned long long> statBytesDecoded(0);
+static std::atomic<unsigned long long> statNanosecondsDecode(0);
+
+bool leaf_codec_enabled() {
+  static bool enabled = false;
+  static std::once_flag flag;
+  std::call_once(flag, []() {
+      char const * s = getenv("LEAF_COMPRESSION");
+      enabled = s && atoi(s) != 0;
+    });
+  return enabled;
+}
+
+/* Byte k of element i XOR element i-1 is stored at planes[k*nElements+i]. */
+template<typename T>
+static void xor_shuffle(char const * src, size_t nElements, unsigned char * planes) {
+  T prev = 0;
+  for(size_t i = 0; i < nElements; i++) {
+    T x;
+    memcpy(&x, src + i*sizeof(T), sizeof(T));
+    T d = x ^ prev;
+    prev = x;
+    for(size_t k = 0; k < sizeof(T); k++)
+      planes[k*nElements+i] = (unsigned char)(d >> (8*k));
+  }
+}
+
+template<typename T>
+static void xor_unshuffle(unsigned char const * planes, size_t nElements, char * dst) {
+  T prev = 0;
+  for(size_t i = 0; i < nElements; i++) {
+    T d = 0;
+    for(size_t k = 0; k < sizeof(T); k++)
+      d |= (T)planes[k*nElements+i] << (8*k);
+    prev ^= d;
+    memcpy(dst + i*sizeof(T), &prev, sizeof(T));
+  }
+}
+
+static const size_t RLE_MAX_LITERALS = 128;
+static const size_t RLE_MIN_RUN = 3;
+static const size_t RLE_MAX_RUN = 130;
+
+static void rle_flush_literals(unsigned char const * p, size_t count, std::vector<char> & dst) {
+  while(count > 0) {
+    size_t chunk = count < RLE_MAX_LITERALS ? count : RLE_MAX_LITERALS;
+    dst.push_back((char)(chunk - 1));
+    dst.insert(dst.end(), (char const *)p, (char const *)p + chunk);
+    p += chunk;
+    count -= chunk;
+  }
+}
+
+static void rle_encode(unsigned char const * src, size_t n, std::vector<char> & dst) {
+  size_t i = 0;
+  size_t literalStart = 0;
+  while(i < n) {
+    size_t run = 1;
+    while(i+run < n && run < RLE_MAX_RUN && src[i+run] == src[i])
+      run++;
+    if(run < RLE_MIN_RUN) {
+      i += run;
+      continue;
+    }
+    rle_flush_literals(src + literalStart, i - literalStart, dst);
+    dst.push_back((char)(run + RLE_MAX_LITERALS - RLE_MIN_RUN));
+    dst.push_back((char)src[i]);
+    i += run;
+    literalStart = i;
+  }
+  rle_flush_literals(src + literalStart, n - literalStart, dst);
+}
+
+static void rle_decode(unsigned char const * src, size_t srcBytes, unsigned char * dst, size_t n) {
+  size_t i = 0;
+  size_t j = 0;
+  while(i < srcBytes) {
+    size_t c = src[i++];
+    if(c < RLE_MAX_LITERALS) {
+      size_t count = c + 1;
+      if(i + count > srcBytes || j + count > n)
+	throw std::runtime_error("Error in leaf_codec_decode: corrupt literal run.");
+      memcpy(dst + j, src + i, count);
+      i += count;
+      j += count;
+    }
+    else {
+      size_t count = c + RLE_MIN_RUN - RLE_MAX_LITERALS;
+      if(i >= srcBytes || j + count > n)
+	throw std::runtime_error("Error in leaf_codec_decode: corrupt repeat run.");
+      memset(dst + j, src[i++], count);
+      j += count;
+    }
+  }
+  if(j != n)
+    throw std::runtime_error("Error in leaf_codec_decode: wrong decoded size.");
+}
+
+static unsigned long long nanoseconds_since(double startTime) {
+  return (unsigned long long)((bench_seconds() - startTime) * 1e9);
+}
+
+size_t leaf_codec_encode(char const * src, size_t nBytes, size_t elementSize, std::vector<char> & dst) {
+  if(elementSize != sizeof(uint64_t) && elementSize != sizeof(uint32_t))
+    throw std::runtime_error("Error in leaf_codec_encode: elementSize must be 4 or 8.");
+  if(nBytes % elementSize != 0)
+    throw std::runtime_error("Error in leaf_codec_encode: nBytes not a multiple of elementSize.");
+  double startTime = bench_seconds();
+  size_t nElements = nBytes / elementSize;
+  std::vector<unsigned char> planes(nBytes);
+  if(elementSize == sizeof(uint64_t))
+    xor_shuffle<uint64_t>(src, nElements, &planes[0]);
+  else
+    xor_shuffle<uint32_t>(src, nElements, &planes[0]);
+  size_t oldSize = dst.size();
+  // Worst case is one control byte per 128 literal bytes
+  dst.reserve(oldSize + nBytes + nBytes / RLE_MAX_LITERALS + 1);
+  rle_encode(&planes[0], nBytes, dst);
+  size_t encodedBytes = dst.size() - oldSize;
+  statBytesEncoded += nBytes;
+  statBytesEncodedOut += encodedBytes;
+  statNanosecondsEncode += nanoseconds_since(startTime);
+  return encodedBytes;
+}
+
+void leaf_codec_decode(char const * src, size_t srcBytes, size_t elementSize, char * dst, size_t nBytes) {
+  if(elementSize != sizeof(uint64_t) && elementSize != sizeof(uint32_t))
+    throw std::runtime_error("Error in leaf_codec_decode: elementSize must be 4 or 8.");
+  if(nBytes % elementSize != 0)
+    throw std::runtime_error("Error in leaf_codec_decode: nBytes not a multiple of elementSize.");
+  double startTime = bench_seconds();
+  size_t nElements = nBytes / elementSize;
+  std::vector<unsigned char> planes(nBytes);
+  rle_decode((unsigned char const *)src, srcBytes, &planes[0], nBytes);
+  if(elementSize == sizeof(uint64_t))
+    xor_unshuffle<uint64_t>(&planes[0], nElements, dst);
+  else
+    xor_unshuffle<uint32_t>(&planes[0], nElements, dst);
+  statBytesDecoded += nBytes;
+  statNanosecondsDecode += nanoseconds_since(startTime);
+}
+
+LeafCodecStatistics leaf_codec_statistics() {
+  LeafCodecStatistics s;
+  s.bytesEncoded = statBytesEncoded.load();
+  s.bytesEncodedOut = statBytesEncodedOut.load();
+  s.secondsEncode = statNanosecondsEncode.load() / 1e9;
+  s.bytesDecoded = statBytesDecoded.load();
+  s.secondsDecode = statNanosecondsDecode.load() / 1e9;
+  return s;
+}
+
+void leaf_codec_reset_statistics() {
+  statBytesEncoded.store(0);
+  statBytesEncodedOut.store(0);
+  statNanosecondsEncode.store(0);
+  statBytesDecoded.store(0);
+  statNanosecondsDecode.store(0);
+}
@@ -0,0 +1,38 @@
+#ifndef LEAFCODEC_HEADER
+#define LEAFCODEC_HEADER
+
+#include <cstddef>
+#include <vector>
+
+/* Lossless codec for the elements of CMatrix leaves. Each element is
+   XORed with the previous one, so that the sign, exponent and leading
+   mantissa bits of smooth data become zero bytes. The bytes are then
+   shuffled so that byte k of all elements is stored together, and the
+   result is run-length encoded (PackBits style: a control byte c <
+   128 is followed by c+1 literal bytes, c >= 128 by one byte that is
+   repeated c-125 times). elementSize is 8 for double and 4 for float
+   elements, and nBytes must be a multiple of it.
+
+   Compression of leaves in CMatrix::writeToBuffer is enabled by the
+   environment variable LEAF_COMPRESSION=1 in each process. Decoding
+   is always possible since every serialized leaf says whether it is
+   encoded, so compressed and uncompressed chunks can be mixed. */
+bool leaf_codec_enabled();
+// Appends the encoded bytes to dst and returns the number appended
+size_t leaf_codec_encode(char const * src, size_t nBytes, size_t elementSize, std::vector<char> & dst);
+// Decodes srcBytes encoded bytes into nBytes bytes at dst
+void leaf_codec_decode(char const * src, size_t srcBytes, size_t elementSize, char * dst, size_t nBytes);
+
+/* Codec statistics of this process, updated by the encode and decode
+   calls from all threads. */
+struct LeafCodecStatistics {
+  double bytesEncoded; // raw bytes given to leaf_codec_encode
+  double bytesEncodedOut; // encoded bytes produced
+  double secondsEncode;
+  double bytesDecoded; // raw bytes produced by leaf_codec_decode
+  double secondsDecode;
+};
+LeafCodecStatistics leaf_codec_statistics();
+void leaf_codec_reset_statistics();
+
+#endif
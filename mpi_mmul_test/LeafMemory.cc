@@ -0,0 +1,131 @@
+#include "LeafMemory.h"
+#include <atomic>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <cerrno>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Updated from several worker threads
+static std::atomic<size_t> currentBytes(0);
+static std::atomic<size_t> peakBytes(0);
+// In use plus pooled
+static std::atomic<size_t> heldBytes(0);
+static std::atomic<size_t> peakHeldBytes(0);
+
+static void update_peak(std::atomic<size_t> & peakCounter, size_t current) {
+  size_t peak = peakCounter.load();
+  while(current > peak && !peakCounter.compare_exchange_weak(peak, current))
+    ;
+}
+
+// Free blocks, per block size in doubles
+static std::mutex poolMutex;
+static std::map<size_t, std::vector<double*> > pool;
+static const size_t MAX_POOLED_BLOCKS_PER_SIZE = 32;
+
+double* leaf_memory_get(size_t nDoubles) {
+  size_t bytes = nDoubles*sizeof(double);
+  update_peak(peakBytes, currentBytes.fetch_add(bytes) + bytes);
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    std::vector<double*> & freeBlocks = pool[nDoubles];
+    if(!freeBlocks.empty()) {
+      double* p = freeBlocks.back();
+      freeBlocks.pop_back();
+      return p;
+    }
+  }
+  void* p = 0;
+  if(posix_memalign(&p, LEAF_MEMORY_ALIGNMENT, bytes) != 0)
+    throw std::bad_alloc();
+  update_peak(peakHeldBytes, heldBytes.fetch_add(bytes) + bytes);
+  return (double*)p;
+}
+void leaf_memory_release(double* p, size_t nDoubles) {
+  currentBytes.fetch_sub(nDoubles*sizeof(double));
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    std::vector<double*> & freeBlocks = pool[nDoubles];
+    if(freeBlocks.size() < MAX_POOLED_BLOCKS_PER_SIZE) {
+      freeBlocks.push_back(p);
+      return;
+    }
+  }
+  heldBytes.fetch_sub(nDoubles*sizeof(double));
+  free(p);
+}
+size_t leaf_memory_current() {
+  return currentBytes.load();
+}
+size_t leaf_memory_peak() {
+  return peakBytes.load();
+}
+size_t leaf_memory_peak_held() {
+  return peakHeldBytes.load();
+}
+void leaf_memory_reset_peak() {
+  peakBytes.store(currentBytes.load());
+  peakHeldBytes.store(heldBytes.load());
+}
+
+LeafBuffer::LeafBuffer(LeafBuffer const & other) : p(0), sz(0), mapBase(0), mapBytes(0) {
+  *this = other;
+}
+LeafBuffer & LeafBuffer::operator=(LeafBuffer const & other) {
+  if(this == &other)
+    return *this;
+  resize(other.sz);
+  if(sz > 0)
+    memcpy(p, other.p, sz*sizeof(double));
+  return *this;
+}
+void LeafBuffer::resize(size_t newSize) {
+  if(newSize == sz)
+    return;
+  // Old contents are not kept, leaves are always filled after resize
+  clear();
+  if(newSize > 0) {
+    p = leaf_memory_get(newSize);
+    sz = newSize;
+  }
+}
+void LeafBuffer::clear() {
+  if(mapBase)
+    munmap(mapBase, mapBytes);
+  else if(p)
+    leaf_memory_release(p, sz);
+  p = 0;
+  sz = 0;
+  mapBase = 0;
+  mapBytes = 0;
+}
+void LeafBuffer::mapFile(int fd, size_t offset, size_t newSize) {
+  if(offset % LEAF_MEMORY_ALIGNMENT != 0)
+    throw std::runtime_error("Error in LeafBuffer::mapFile: offset not aligned.");
+  clear();
+  if(newSize == 0)
+    return;
+  // mmap needs a page-aligned file offset, the elements start inside the first page
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+  size_t start = offset - offset % pageSize;
+  size_t bytes = offset - start + newSize*sizeof(double);
+  int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+  // Reads the pages in now, so that loading is timed with its I/O rather than the first use
+  flags |= MAP_POPULATE;
+#endif
+  void* base = mmap(0, bytes, PROT_READ | PROT_WRITE, flags, fd, start);
+  if(base == MAP_FAILED)
+    throw std::runtime_error(std::string("Error in LeafBuffer::mapFile: mmap failed: ") + strerror(errno));
+  mapBase = base;
+  mapBytes = bytes;
+  p = (double*)((char*)base + (offset - start));
+  sz = newSize;
+}
@@ -0,0 +1,63 @@
+#ifndef LEAFMEMORY_HEADER
+#define LEAFMEMORY_HEADER
+
+#include <cstddef>
+#include <utility>
+
+/* Memory for CMatrix leaf elements. Blocks are 64-byte aligned (cache
+   line and AVX-512 vector size) and freed blocks are kept in a pool,
+   per block size, for reuse by later leaves. Since all leaves in a
+   quad-tree have the same size this avoids most calls to the system
+   allocator. The memory used is also accounted per process, to
+   compare peak memory usage of different multiply strategies:
+   leaf_memory_peak counts blocks in use by leaves, and
+   leaf_memory_peak_held also the free blocks kept in the pool, i.e.
+   what the process holds from the system allocator. */
+static const size_t LEAF_MEMORY_ALIGNMENT = 64;
+double* leaf_memory_get(size_t nDoubles);
+void leaf_memory_release(double* p, size_t nDoubles);
+size_t leaf_memory_current();
+size_t leaf_memory_peak();
+size_t leaf_memory_peak_held();
+// Resets both peaks to the current usage
+void leaf_memory_reset_peak();
+
+/* Element storage for CMatrix leaves, similar to std::vector<double>
+   but aligned, pooled, and resize() does not initialize the
+   elements. The elements can also be mapped from a file, then they
+   are read from the file when first touched and the pages belong to
+   the page cache, so they are not counted as leaf memory. */
+class LeafBuffer {
+ public:
+  LeafBuffer() : p(0), sz(0), mapBase(0), mapBytes(0) { }
+  LeafBuffer(LeafBuffer const & other);
+  LeafBuffer & operator=(LeafBuffer const & other);
+  ~LeafBuffer() { clear(); }
+  // Elements are left uninitialized
+  void resize(size_t newSize);
+  void clear();
+  /* Maps newSize elements at offset in the open file fd, copy-on-write
+     so the file is never changed, and prefaults them where
+     MAP_POPULATE exists. offset must be a multiple of
+     LEAF_MEMORY_ALIGNMENT, fd may be closed afterwards. */
+  void mapFile(int fd, size_t offset, size_t newSize);
+  bool isMapped() const { return mapBase != 0; }
+  void swap(LeafBuffer & other) {
+    std::swap(p, other.p);
+    std::swap(sz, other.sz);
+    std::swap(mapBase, other.mapBase);
+    std::swap(mapBytes, other.mapBytes);
+  }
+  size_t size() const { return sz; }
+  double* data() { return p; }
+  double const * data() const { return p; }
+  double & operator[](size_t i) { return p[i]; }
+  double const & operator[](size_t i) const { return p[i]; }
+ private:
+  double* p;
+  size_t sz;
+  void* mapBase; // start of the page-aligned mapping, if mapped
+  size_t mapBytes;
+};
+
+#endif
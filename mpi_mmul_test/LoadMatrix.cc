@@ -0,0 +1,99 @@
+#include "LoadMatrix.h"
+#include "TaskProfile.h"
+#include "CVector.h"
+#include "CreateMatrixFromIdsAndNorms.h"
+#include "CreateSymmMatrixFromIdsAndNorms.h"
+#include "CreateMatrixFromIds.h"
+#include "CreateSymmMatrixFromIds.h"
+#include "CreateMatrixFromIdsWithNorms.h"
+#include "CreateSymmMatrixFromIdsWithNorms.h"
+#include <unistd.h>
+
+CHT_TASK_TYPE_IMPLEMENTATION((LoadMatrix));
+cht::ID LoadMatrix::execute(CInt const & matSize,
+			    CInt const & baseIdx1,
+			    CInt const & baseIdx2,
+			    CMatrixFile const & file) {
+  TaskProfileScope profile("LoadMatrix", matSize);
+  MatrixFileHeader const & header = file.header;
+  int n = matSize;
+  int blockSize = header.blockSize;
+  MatrixFileNode node;
+  int fd = matrix_file_open(file.path, false);
+  try {
+    matrix_file_read(fd, &node, sizeof(node), matrix_file_node_offset(header, n, baseIdx1 / n, baseIdx2 / n));
+  }
+  catch(...) {
+    close(fd);
+    throw;
+  }
+  if(!(node.flags & MATRIX_FILE_NODE_PRESENT)) {
+    // Zero matrix, never written
+    close(fd);
+    return cht::CHUNK_ID_NULL;
+  }
+  if(n <= blockSize) {
+    // Lowest level
+    CMatrix* A = new CMatrix();
+    A->n = n;
+    A->blockSize = blockSize;
+    A->leafType = node.leafType;
+    A->symmetric = (node.flags & MATRIX_FILE_NODE_SYMMETRIC) ? 1 : 0;
+    A->norm = node.norm;
+    try {
+      // The file may have been truncated since its header was read
+      matrix_file_check_size(fd, header, file.path);
+      A->elements.mapFile(fd, node.dataOffset, A->hasFloatElements() ? (n*n+1)/2 : n*n);
+      if(file.verifyChecksums && matrix_file_checksum(A->elements.data(), A->leafElementBytes()) != node.checksum)
+	throw std::runtime_error("Error in LoadMatrix::execute: leaf checksum mismatch in '" + file.path + "'.");
+    }
+    catch(...) {
+      close(fd);
+      delete A;
+      throw;
+    }
+    // The mapping stays valid after the file is closed
+    close(fd);
+    return registerChunk(A, cht::persistent);
+  }
+  else {
+    // Not lowest level
+    close(fd);
+    int nHalf = n / 2;
+    cht::ChunkID cid_nHalf = registerChunk( new CInt(nHalf) );
+    cht::ID childTaskIDs[4];
+    for(int i = 0; i < 4; i++) {
+      if(!(node.flags & (MATRIX_FILE_NODE_CHILD << i))) {
+	childTaskIDs[i] = cht::CHUNK_ID_NULL;
+	continue;
+      }
+      cht::ChunkID cid_baseIdx1 = registerChunk( new CInt(baseIdx1 + (i/2)*nHalf) );
+      cht::ChunkID cid_baseIdx2 = registerChunk( new CInt(baseIdx2 + (i%2)*nHalf) );
+      childTaskIDs[i] = registerTask<LoadMatrix>(cid_nHalf, cid_baseIdx1, cid_baseIdx2, getInputChunkID(file));
+    }
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(blockSize) );
+    bool symmetric = (node.flags & MATRIX_FILE_NODE_SYMMETRIC) != 0;
+    if(!file.withNorms) {
+      if(symmetric)
+	return registerTask<CreateSymmMatrixFromIds>(getInputChunkID(matSize), cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+      return registerTask<CreateMatrixFromIds>(getInputChunkID(matSize), cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+    }
+    // Files of matrices saved without norms have norm -1, then the children are fetched for them
+    if(node.norm < 0) {
+      if(symmetric)
+	return registerTask<CreateSymmMatrixFromIdsWithNorms>(getInputChunkID(matSize), cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+      return registerTask<CreateMatrixFromIdsWithNorms>(getInputChunkID(matSize), cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+    }
+    // The child norms are in the node index, so the children need not be fetched for them
+    CVector* childNorms = new CVector();
+    childNorms->n = 4;
+    childNorms->blockSize = 4;
+    childNorms->elements.assign(node.childNorms, node.childNorms + 4);
+    cht::ChunkID cid_childNorms = registerChunk(childNorms);
+    if(symmetric)
+      return registerTask<CreateSymmMatrixFromIdsAndNorms>(getInputChunkID(matSize), cid_blockSize, cid_childNorms,
+							   childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+    return registerTask<CreateMatrixFromIdsAndNorms>(getInputChunkID(matSize), cid_blockSize, cid_childNorms,
+						     childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+  }
+} // end execute
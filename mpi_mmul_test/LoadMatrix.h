@@ -0,0 +1,15 @@
+#include "chunks_and_tasks.h"
+#include "CInt.h"
+#include "CMatrix.h"
+#include "CMatrixFile.h"
+
+/* Loads the matrix of size n whose top left element is (baseIdx1,
+   baseIdx2) from a file written by SaveMatrix, in one task per node
+   like CreateMatrix. Leaf elements are mmap'ed from the file rather
+   than read. */
+struct LoadMatrix: public cht::Task {
+  cht::ID execute(CInt const &, CInt const &, CInt const &, CMatrixFile const &);
+  CHT_TASK_INPUT((CInt, CInt, CInt, CMatrixFile));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -1,9 +1,12 @@
 #include "chunks_and_tasks.h"
 #include "CMatrix.h"
 
+/* Computes A + B where either of A and B may be CHUNK_ID_NULL,
+   meaning an all-zero matrix. If one operand is zero the other one is
+   forwarded, otherwise the work is done by MatrixAddNonNull. */
 struct MatrixAdd: public cht::Task {
-  cht::ID execute(CMatrix const &, CMatrix const &);
-  CHT_TASK_INPUT((CMatrix, CMatrix));
+  cht::ID execute(cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((cht::ChunkID, cht::ChunkID));
   CHT_TASK_OUTPUT((CMatrix));
   CHT_TASK_TYPE_DECLARATION;
 };
@@ -0,0 +1,54 @@
+#include "MatrixAddNonNull.h"
+#include "TaskProfile.h"
+#include "MatrixAdd.h"
+#include "MatrixLeafKernels.h"
+#include "CreateMatrixFromIds.h"
+#include "CreateSymmMatrixFromIds.h"
+#include "CreateMatrixFromIdsWithNorms.h"
+#include "CreateSymmMatrixFromIdsWithNorms.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixAddNonNull));
+cht::ID MatrixAddNonNull::execute(CMatrix const & A, CMatrix const & B) {
+  TaskProfileScope profile("MatrixAddNonNull", A.n);
+  int nA = A.n;
+  int nB = B.n;
+  if(nA != nB || A.blockSize != B.blockSize)
+    throw std::runtime_error("Error in MatrixAddNonNull::execute: (nA != nB || A.blockSize != B.blockSize).");
+  // Symmetric leaves store all elements, so only non-leaves must agree
+  if(A.symmetric != B.symmetric && !A.isLeaf())
+    throw std::runtime_error("Error in MatrixAddNonNull::execute: symmetric and general matrices cannot be added.");
+  int n = nA;
+  if(A.isLeaf()) {
+    // Lowest level
+    CMatrix* C = new CMatrix();
+    C->n = n;
+    C->blockSize = A.blockSize;
+    C->symmetric = A.symmetric && B.symmetric;
+    C->elements.resize(n*n);
+    // Float leaves are converted to double and back
+    LeafBuffer tmpA, tmpB;
+    leaf_add(n, A.getDoubleElements(tmpA), B.getDoubleElements(tmpB), &C->elements[0]);
+    C->setLeafType(A.leafType);
+    profile.addFlops((double)n*n);
+    C->setNormFromElements();
+    return registerChunk(C, cht::persistent);
+  }
+  else {
+    // Not lowest level. Children may be CHUNK_ID_NULL, that is handled by MatrixAdd.
+    cht::ID childTaskIDs[4];
+    for(int i = 0; i < 2; i++)
+      for(int j = 0; j < 2; j++)
+	childTaskIDs[i*2+j] = registerTask<MatrixAdd>(A.children[i*2+j], B.children[i*2+j]);
+    cht::ChunkID cid_n = registerChunk( new CInt(n) );
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(A.blockSize) );
+    // The sum keeps norms only if both terms have them, e.g. in a screened multiply
+    if(A.hasNorms() && B.hasNorms()) {
+      if(A.symmetric)
+	return registerTask<CreateSymmMatrixFromIdsWithNorms>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+      return registerTask<CreateMatrixFromIdsWithNorms>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+    }
+    if(A.symmetric)
+      return registerTask<CreateSymmMatrixFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+    return registerTask<CreateMatrixFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+  }
+} // end execute
@@ -0,0 +1,9 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+
+struct MatrixAddNonNull: public cht::Task {
+  cht::ID execute(CMatrix const &, CMatrix const &);
+  CHT_TASK_INPUT((CMatrix, CMatrix));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
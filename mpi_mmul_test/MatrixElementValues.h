@@ -1,11 +1,36 @@
 #include <cmath>
 const int MATRIX_TYPE_A = 1;
 const int MATRIX_TYPE_B = 2;
+/* Matrices with elements decaying exponentially away from the
+   diagonal, |A_ij| <= 1.5 exp(-|i-j| / MATRIX_DECAY_LENGTH), like the
+   matrices of many physical systems. Products of off-diagonal blocks
+   are then small and can be screened. */
+const int MATRIX_TYPE_DECAY_A = 3;
+const int MATRIX_TYPE_DECAY_B = 4;
+const double MATRIX_DECAY_LENGTH = 50;
 static double matElementFunc(int matType, int i, int j) {
   if(matType == MATRIX_TYPE_A)
     return sin(0.3 + 0.01*i + 0.123*j) + cos(0.4*i) + 0.01 * (i % 2) + 0.02 * (j % 3);
   else if(matType == MATRIX_TYPE_B)
     return cos(0.1 + 0.07*i + 0.432*j) + sin(0.3*i) + 0.05 * (i % 4) + 0.01 * (j % 3);
+  else if(matType == MATRIX_TYPE_DECAY_A)
+    return exp(-std::fabs((double)(i - j)) / MATRIX_DECAY_LENGTH) * (1 + 0.5 * sin(0.3 + 0.01*i + 0.123*j));
+  else if(matType == MATRIX_TYPE_DECAY_B)
+    return exp(-std::fabs((double)(i - j)) / MATRIX_DECAY_LENGTH) * (1 + 0.5 * cos(0.1 + 0.07*i + 0.432*j));
   else
     return 0;
 }
+// Symmetric part of the element function, for symmetric test matrices
+static inline double symmMatElementFunc(int matType, int i, int j) {
+  return 0.5 * (matElementFunc(matType, i, j) + matElementFunc(matType, j, i));
+}
+/* Pseudo-random value in [-1, 1) depending only on seed and index,
+   so that any process can create any part of a random vector. */
+static inline double vectorElementFunc(int seed, int i) {
+  unsigned long long x = (unsigned long long)(unsigned int)seed * 0x9E3779B97F4A7C15ULL + (unsigned long long)i;
+  // splitmix64 finalizer
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  x = x ^ (x >> 31);
+  return (double)(x >> 11) / (double)(1ULL << 52) - 1.0;
+}
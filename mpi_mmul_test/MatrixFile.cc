@@ -0,0 +1,197 @@
+#include "MatrixFile.h"
+#include "LeafMemory.h"
+#include "CMatrix.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cstdio>
+
+static const uint64_t FLETCHER_MODULUS = 0xFFFFFFFFULL;
+// Words summed between reductions, small enough that the sums cannot overflow
+static const size_t FLETCHER_BLOCK_WORDS = 1024;
+
+uint64_t matrix_file_checksum(void const * data, size_t nBytes) {
+  if(nBytes % sizeof(uint32_t) != 0)
+    throw std::runtime_error("Error in matrix_file_checksum: nBytes not a multiple of 4.");
+  char const * p = (char const *)data;
+  size_t nWords = nBytes / sizeof(uint32_t);
+  uint64_t sum1 = 0;
+  uint64_t sum2 = 0;
+  for(size_t start = 0; start < nWords; start += FLETCHER_BLOCK_WORDS) {
+    size_t end = start + FLETCHER_BLOCK_WORDS < nWords ? start + FLETCHER_BLOCK_WORDS : nWords;
+    for(size_t i = start; i < end; i++) {
+      uint32_t w;
+      memcpy(&w, p + i*sizeof(uint32_t), sizeof(uint32_t));
+      sum1 += w;
+      sum2 += sum1;
+    }
+    sum1 %= FLETCHER_MODULUS;
+    sum2 %= FLETCHER_MODULUS;
+  }
+  return (sum2 << 32) | sum1;
+}
+
+static uint64_t round_up(uint64_t x, uint64_t multiple) {
+  return (x + multiple - 1) / multiple * multiple;
+}
+
+static std::string error_text(std::string const & what) {
+  return "Error in matrix file: " + what + ": " + strerror(errno);
+}
+
+int matrix_file_open(std::string const & path, bool forWriting) {
+  int fd = open(path.c_str(), forWriting ? O_RDWR : O_RDONLY);
+  if(fd < 0)
+    throw std::runtime_error(error_text("cannot open '" + path + "'"));
+  return fd;
+}
+
+void matrix_file_read(int fd, void * buf, size_t nBytes, uint64_t offset) {
+  char* p = (char*)buf;
+  while(nBytes > 0) {
+    ssize_t n = pread(fd, p, nBytes, offset);
+    if(n < 0 && errno == EINTR)
+      continue;
+    if(n < 0)
+      throw std::runtime_error(error_text("pread failed"));
+    if(n == 0)
+      throw std::runtime_error("Error in matrix file: unexpected end of file.");
+    p += n;
+    nBytes -= n;
+    offset += n;
+  }
+}
+
+void matrix_file_write(int fd, void const * buf, size_t nBytes, uint64_t offset) {
+  char const * p = (char const *)buf;
+  while(nBytes > 0) {
+    ssize_t n = pwrite(fd, p, nBytes, offset);
+    if(n < 0 && errno == EINTR)
+      continue;
+    if(n < 0)
+      throw std::runtime_error(error_text("pwrite failed"));
+    p += n;
+    nBytes -= n;
+    offset += n;
+  }
+}
+
+void matrix_file_check_size(int fd, MatrixFileHeader const & header, std::string const & path) {
+  struct stat st;
+  if(fstat(fd, &st) != 0)
+    throw std::runtime_error(error_text("fstat failed for '" + path + "'"));
+  if((uint64_t)st.st_size < header.fileBytes)
+    throw std::runtime_error("Error in matrix file: '" + path + "' is truncated, " + std::to_string((long long)st.st_size)
+			     + " bytes of " + std::to_string((unsigned long long)header.fileBytes) + ".");
+}
+
+static uint64_t header_checksum(MatrixFileHeader const & header) {
+  return matrix_file_checksum(&header, offsetof(MatrixFileHeader, headerChecksum));
+}
+
+// The node index is mapped rather than read, it can be large
+static uint64_t index_checksum(int fd, MatrixFileHeader const & header) {
+  LeafBuffer index;
+  index.mapFile(fd, header.indexOffset, header.nNodes * sizeof(MatrixFileNode) / sizeof(double));
+  return matrix_file_checksum(index.data(), header.nNodes * sizeof(MatrixFileNode));
+}
+
+void matrix_file_create(std::string const & path, int N, int n, int blockSize, int leafType, MatrixFileHeader & header) {
+  int nLevels = 0;
+  while(((int64_t)blockSize << nLevels) < n)
+    nLevels++;
+  if(((int64_t)blockSize << nLevels) != n)
+    throw std::runtime_error("Error in matrix_file_create: n is not blockSize * 2^k.");
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MATRIX_FILE_MAGIC, sizeof(header.magic));
+  header.version = MATRIX_FILE_VERSION;
+  header.headerBytes = sizeof(MatrixFileHeader);
+  header.N = N;
+  header.n = n;
+  header.blockSize = blockSize;
+  header.nLevels = nLevels;
+  header.leafType = leafType;
+  uint64_t nLeavesPerSide = (uint64_t)1 << nLevels;
+  // Sum of 4^l for l = 0, ..., nLevels
+  header.nNodes = (nLeavesPerSide * nLeavesPerSide * 4 - 1) / 3;
+  header.indexOffset = round_up(sizeof(MatrixFileHeader), LEAF_MEMORY_ALIGNMENT);
+  header.dataOffset = round_up(header.indexOffset + header.nNodes * sizeof(MatrixFileNode), LEAF_MEMORY_ALIGNMENT);
+  size_t elementBytes = leafType == CMatrix::LEAF_DOUBLE ? sizeof(double) : sizeof(float);
+  header.leafSlotBytes = round_up((uint64_t)blockSize * blockSize * elementBytes, LEAF_MEMORY_ALIGNMENT);
+  header.fileBytes = header.dataOffset + nLeavesPerSide * nLeavesPerSide * header.leafSlotBytes;
+  std::string tempPath = matrix_file_temp_path(path);
+  int fd = open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if(fd < 0)
+    throw std::runtime_error(error_text("cannot create '" + tempPath + "'"));
+  // Extends the file with zeros, a sparse file where supported
+  if(ftruncate(fd, header.fileBytes) != 0) {
+    close(fd);
+    throw std::runtime_error(error_text("ftruncate failed"));
+  }
+  matrix_file_write(fd, &header, sizeof(header), 0);
+  close(fd);
+}
+
+std::string matrix_file_temp_path(std::string const & path) {
+  return path + ".tmp";
+}
+
+void matrix_file_finalize(std::string const & path) {
+  std::string tempPath = matrix_file_temp_path(path);
+  int fd = matrix_file_open(tempPath, true);
+  MatrixFileHeader header;
+  matrix_file_read(fd, &header, sizeof(header), 0);
+  header.indexChecksum = index_checksum(fd, header);
+  header.headerChecksum = header_checksum(header);
+  matrix_file_write(fd, &header, sizeof(header), 0);
+  if(fsync(fd) != 0) {
+    close(fd);
+    throw std::runtime_error(error_text("fsync failed"));
+  }
+  close(fd);
+  if(rename(tempPath.c_str(), path.c_str()) != 0)
+    throw std::runtime_error(error_text("cannot rename '" + tempPath + "' to '" + path + "'"));
+}
+
+void matrix_file_read_header(std::string const & path, MatrixFileHeader & header) {
+  int fd = matrix_file_open(path, false);
+  matrix_file_read(fd, &header, sizeof(header), 0);
+  try {
+    if(memcmp(header.magic, MATRIX_FILE_MAGIC, sizeof(header.magic)) != 0)
+      throw std::runtime_error("Error in matrix_file_read_header: '" + path + "' is not a matrix file.");
+    if(header.version != MATRIX_FILE_VERSION || header.headerBytes != sizeof(MatrixFileHeader))
+      throw std::runtime_error("Error in matrix_file_read_header: '" + path + "' has an unsupported version.");
+    if(header.headerChecksum != header_checksum(header))
+      throw std::runtime_error("Error in matrix_file_read_header: header checksum mismatch in '" + path + "'.");
+    // Before the index is mapped, reading a mapping beyond the end of the file gives SIGBUS
+    matrix_file_check_size(fd, header, path);
+    if(header.indexChecksum != index_checksum(fd, header))
+      throw std::runtime_error("Error in matrix_file_read_header: node index checksum mismatch in '" + path + "'.");
+  }
+  catch(...) {
+    close(fd);
+    throw;
+  }
+  close(fd);
+}
+
+uint64_t matrix_file_node_offset(MatrixFileHeader const & header, int nodeN, int blockIdx1, int blockIdx2) {
+  // The node size is n / 2^level
+  int level = 0;
+  while(level < header.nLevels && ((int64_t)nodeN << level) < header.n)
+    level++;
+  if(((int64_t)nodeN << level) != header.n)
+    throw std::runtime_error("Error in matrix_file_node_offset: node size does not match the file.");
+  uint64_t nPerSide = (uint64_t)1 << level;
+  uint64_t levelStart = (nPerSide * nPerSide - 1) / 3;
+  return header.indexOffset + (levelStart + blockIdx1 * nPerSide + blockIdx2) * sizeof(MatrixFileNode);
+}
+
+uint64_t matrix_file_leaf_offset(MatrixFileHeader const & header, int blockIdx1, int blockIdx2) {
+  uint64_t nPerSide = (uint64_t)1 << header.nLevels;
+  return header.dataOffset + (blockIdx1 * nPerSide + blockIdx2) * header.leafSlotBytes;
+}
@@ -0,0 +1,92 @@
+#ifndef MATRIXFILE_HEADER
+#define MATRIXFILE_HEADER
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+/* On-disk format for CMatrix quad-trees, written by SaveMatrix and
+   read by LoadMatrix. A file consists of
+
+     header       MatrixFileHeader, at offset 0
+     node index   one MatrixFileNode per possible node, at indexOffset
+     leaf blocks  one slot of leafSlotBytes per possible leaf, at dataOffset
+
+   The node (blockIdx1, blockIdx2) at level l, where the root is level
+   0 and the leaves are level nLevels, is entry
+   (4^l - 1) / 3 + blockIdx1 * 2^l + blockIdx2 of the node index, and
+   leaf (blockIdx1, blockIdx2) is slot blockIdx1 * 2^nLevels +
+   blockIdx2. Since every node and leaf has a fixed place, each one is
+   written and read by its own task without coordination. Zero nodes
+   are never written and read back as not present, and on file systems
+   with sparse files the unwritten parts take no disk space.
+
+   Leaves are stored row-major as in CMatrix, float leaves packed.
+   indexOffset, dataOffset and leafSlotBytes are multiples of 64, so
+   leaves can be mmap'ed with the 64-byte alignment of LeafBuffer.
+   Integers and floating point numbers are in the byte order of the
+   machine that wrote the file. */
+
+static const char MATRIX_FILE_MAGIC[8] = {'C', 'H', 'T', 'Q', 'T', 'R', 'E', 'E'};
+static const uint32_t MATRIX_FILE_VERSION = 1;
+
+struct MatrixFileHeader {
+  char magic[8]; // MATRIX_FILE_MAGIC
+  uint32_t version; // MATRIX_FILE_VERSION
+  uint32_t headerBytes; // sizeof(MatrixFileHeader)
+  int64_t N; // logical matrix dimension, elements outside are zero padding
+  int64_t n; // quad-tree dimension, blockSize * 2^nLevels
+  int32_t blockSize;
+  int32_t nLevels;
+  int32_t leafType; // one of the CMatrix::LEAF_* values, same for all leaves
+  int32_t reserved;
+  uint64_t nNodes;
+  uint64_t indexOffset;
+  uint64_t dataOffset;
+  uint64_t leafSlotBytes;
+  uint64_t fileBytes;
+  uint64_t indexChecksum; // matrix_file_checksum of the node index
+  uint64_t headerChecksum; // matrix_file_checksum of the header up to this field
+};
+
+static const uint32_t MATRIX_FILE_NODE_PRESENT = 1;
+static const uint32_t MATRIX_FILE_NODE_SYMMETRIC = 2; // see CMatrix::symmetric
+// Bit MATRIX_FILE_NODE_CHILD << i is set if child i is nonzero
+static const uint32_t MATRIX_FILE_NODE_CHILD = 16;
+
+struct MatrixFileNode {
+  uint64_t dataOffset; // leaves: file offset of the elements
+  uint64_t checksum; // leaves: matrix_file_checksum of the elements
+  double norm; // -1 if the matrix was saved without norms, see CMatrix::hasNorms
+  double childNorms[4]; // non-leaves, -1 as for norm
+  uint32_t flags; // MATRIX_FILE_NODE_* bits
+  int32_t leafType; // leaves: one of the CMatrix::LEAF_* values
+};
+
+// Fletcher-64 checksum, nBytes must be a multiple of 4
+uint64_t matrix_file_checksum(void const * data, size_t nBytes);
+/* Creates the file at matrix_file_temp_path(path) with all nodes
+   zero, so that SaveMatrix tasks can fill it in, and returns its
+   header. matrix_file_finalize sets the checksums when all nodes have
+   been written and renames the file to path. An existing file at path
+   is replaced only then, as a whole, so leaves that LoadMatrix has
+   mapped from it keep their contents. */
+void matrix_file_create(std::string const & path, int N, int n, int blockSize, int leafType, MatrixFileHeader & header);
+std::string matrix_file_temp_path(std::string const & path);
+void matrix_file_finalize(std::string const & path);
+// Reads the header and checks it, the file size and the node index against their checksums
+void matrix_file_read_header(std::string const & path, MatrixFileHeader & header);
+// Offset of node (blockIdx1, blockIdx2) of size nodeN, in blocks of that size
+uint64_t matrix_file_node_offset(MatrixFileHeader const & header, int nodeN, int blockIdx1, int blockIdx2);
+// Offset of the elements of leaf (blockIdx1, blockIdx2)
+uint64_t matrix_file_leaf_offset(MatrixFileHeader const & header, int blockIdx1, int blockIdx2);
+/* Throws std::runtime_error if the open file is shorter than
+   header.fileBytes. Must be called before parts of it are mapped, since
+   touching a mapped page beyond the end of the file raises SIGBUS. */
+void matrix_file_check_size(int fd, MatrixFileHeader const & header, std::string const & path);
+// open, pread and pwrite that throw std::runtime_error on failure
+int matrix_file_open(std::string const & path, bool forWriting);
+void matrix_file_read(int fd, void * buf, size_t nBytes, uint64_t offset);
+void matrix_file_write(int fd, void const * buf, size_t nBytes, uint64_t offset);
+
+#endif
@@ -0,0 +1,278 @@
+#include "MatrixLeafKernels.h"
+#include "CMatrix.h"
+#include "simd_gemm.h"
+#include <cstring>
+#include <cstdlib>
+#include <mutex>
+#include <atomic>
+#include <stdexcept>
+
+extern "C"
+void dgemm_(const char *ta,const char *tb,
+	    const int *n, const int *k, const int *l,
+	    const double *alpha,const double *A,const int *lda,
+	    const double *B, const int *ldb,
+	    const double *beta, double *C, const int *ldc);
+
+extern "C"
+void sgemm_(const char *ta,const char *tb,
+	    const int *n, const int *k, const int *l,
+	    const float *alpha,const float *A,const int *lda,
+	    const float *B, const int *ldb,
+	    const float *beta, float *C, const int *ldc);
+
+// Weak, so that other BLAS libraries can be linked as well
+extern "C"
+void openblas_set_num_threads(int num_threads) __attribute__((weak));
+extern "C"
+int openblas_get_parallel() __attribute__((weak));
+
+extern "C"
+void dsymm_(const char *side, const char *uplo,
+	    const int *m, const int *n,
+	    const double *alpha, const double *A, const int *lda,
+	    const double *B, const int *ldb,
+	    const double *beta, double *C, const int *ldc);
+
+extern "C"
+void dsyrk_(const char *uplo, const char *trans,
+	    const int *n, const int *k,
+	    const double *alpha, const double *A, const int *lda,
+	    const double *beta, double *C, const int *ldc);
+
+extern "C"
+void dgemv_(const char *ta, const int *m, const int *n,
+	    const double *alpha, const double *A, const int *lda,
+	    const double *x, const int *incx,
+	    const double *beta, double *y, const int *incy);
+
+/* If BS is nonzero it is used as the matrix size, otherwise the
+   runtime value nRuntime is used. With BS fixed the compiler knows
+   the loop bounds and strides at compile time. */
+template<int BS>
+static void leaf_add_fixed(int nRuntime, double const * A, double const * B, double * C) {
+  const int n = BS > 0 ? BS : nRuntime;
+  for(int i = 0; i < n*n; i++)
+    C[i] = A[i] + B[i];
+}
+
+template<int BS>
+static void leaf_subtract_fixed(int nRuntime, double const * A, double const * B, double * C) {
+  const int n = BS > 0 ? BS : nRuntime;
+  for(int i = 0; i < n*n; i++)
+    C[i] = A[i] - B[i];
+}
+
+// Selects a fixed-size instantiation of KERNEL for common block sizes
+#define DISPATCH_BLOCK_SIZE(KERNEL, n, ...)				\
+  switch(n) {								\
+  case  128: KERNEL< 128>(n, __VA_ARGS__); break;			\
+  case  256: KERNEL< 256>(n, __VA_ARGS__); break;			\
+  case  512: KERNEL< 512>(n, __VA_ARGS__); break;			\
+  case 1000: KERNEL<1000>(n, __VA_ARGS__); break;			\
+  case 1024: KERNEL<1024>(n, __VA_ARGS__); break;			\
+  case 2048: KERNEL<2048>(n, __VA_ARGS__); break;			\
+  case 4096: KERNEL<4096>(n, __VA_ARGS__); break;			\
+  default:   KERNEL<   0>(n, __VA_ARGS__); break;			\
+  }
+
+int leaf_blas_threads() {
+  static int nThreads = 0;
+  static std::once_flag flag;
+  std::call_once(flag, []() {
+      char const * s = getenv("LEAF_BLAS_THREADS");
+      nThreads = s ? atoi(s) : 1;
+      if(nThreads <= 0)
+	nThreads = 1;
+    });
+  return nThreads;
+}
+
+/* Called before each leaf BLAS call. Several worker threads may call
+   BLAS at once, each with LEAF_BLAS_THREADS threads of its own. That
+   needs an OpenBLAS built with OpenMP (see prepare_openblas.sh), where
+   the thread count set by openblas_set_num_threads is the OpenMP
+   setting of the calling thread, so it is set once in each thread.
+   The pthreads build has one thread pool that is not safe to use from
+   several threads at once, so it is rejected if more than one BLAS
+   thread is asked for. */
+static void leaf_blas_begin() {
+  static thread_local bool threadsSet = false;
+  if(threadsSet)
+    return;
+  int nThreads = leaf_blas_threads();
+  if(nThreads > 1 && openblas_get_parallel && openblas_get_parallel() != 2)
+    throw std::runtime_error("Error in leaf_blas_begin: LEAF_BLAS_THREADS > 1 needs an OpenBLAS built with USE_OPENMP=1.");
+  if(openblas_set_num_threads)
+    openblas_set_num_threads(nThreads);
+  threadsSet = true;
+}
+
+/* Row-major C = op(A) * op(B) is column-major C^T = op(B)^T * op(A)^T,
+   and a row-major matrix seen as column-major is its transpose, so B
+   and A change places while the transpose flags stay as they are. */
+static void leaf_gemm(int n, double const * A, double const * B, bool transA, bool transB, double beta, double * C) {
+  char tA = transA ? 'T' : 'N';
+  char tB = transB ? 'T' : 'N';
+  if(CMatrix::USE_BLAS == 1) {
+    // Use BLAS
+    leaf_blas_begin();
+    double alpha = 1.0;
+    dgemm_(&tB, &tA, &n, &n, &n, &alpha,
+	   B, &n, A, &n,
+	   &beta, C, &n);
+  }
+  else {
+    // Do not use BLAS, use the built-in SIMD kernel instead
+    if(simd_dgemm(tB, tA, n, n, n, B, n, A, n, beta, C, n) != 0)
+      throw std::runtime_error("Error in leaf_gemm: simd_dgemm failed.");
+  }
+}
+
+void leaf_multiply(int n, double const * A, double const * B, bool transA, bool transB, double * C) {
+  leaf_gemm(n, A, B, transA, transB, 0, C);
+}
+
+void leaf_multiply_add(int n, double const * A, double const * B, double * C) {
+  leaf_gemm(n, A, B, false, false, 1, C);
+}
+
+/* S is stored with both triangles, so it is symmetric also in the
+   column-major view and only the side changes. BLAS reads the
+   column-major lower triangle, i.e. the row-major upper triangle. */
+void leaf_symm(int n, double const * S, double const * G, bool sideRight, double * C) {
+  if(CMatrix::USE_BLAS == 1) {
+    leaf_blas_begin();
+    double alpha = 1.0;
+    double beta = 0;
+    dsymm_(sideRight ? "L" : "R", "L", &n, &n, &alpha,
+	   S, &n, G, &n,
+	   &beta, C, &n);
+  }
+  else if(sideRight)
+    leaf_multiply(n, G, S, false, false, C);
+  else
+    leaf_multiply(n, S, G, false, false, C);
+}
+
+void leaf_syrk(int n, double const * A, bool transpose, double * C) {
+  if(CMatrix::USE_BLAS == 1) {
+    leaf_blas_begin();
+    double alpha = 1.0;
+    double beta = 0;
+    // Column-major lower triangle, row-major upper triangle
+    dsyrk_("L", transpose ? "N" : "T", &n, &n, &alpha,
+	   A, &n, &beta, C, &n);
+    // Copy the upper triangle to the lower one
+    for(int i = 0; i < n; i++)
+      for(int j = i+1; j < n; j++)
+	C[j*n+i] = C[i*n+j];
+  }
+  else
+    leaf_multiply(n, A, A, transpose, !transpose, C);
+}
+
+void leaf_add(int n, double const * A, double const * B, double * C) {
+  DISPATCH_BLOCK_SIZE(leaf_add_fixed, n, A, B, C);
+}
+
+void leaf_subtract(int n, double const * A, double const * B, double * C) {
+  DISPATCH_BLOCK_SIZE(leaf_subtract_fixed, n, A, B, C);
+}
+
+void leaf_matvec(int n, double const * A, double const * x, bool transpose, double * y) {
+  if(CMatrix::USE_BLAS == 1) {
+    // Use BLAS. The row-major leaf is seen by BLAS as A^T.
+    leaf_blas_begin();
+    double alpha = 1.0;
+    double beta = 0;
+    int inc = 1;
+    dgemv_(transpose ? "N" : "T", &n, &n, &alpha, A, &n, x, &inc, &beta, y, &inc);
+  }
+  else if(transpose) {
+    for(int j = 0; j < n; j++)
+      y[j] = 0;
+    for(int i = 0; i < n; i++)
+      for(int j = 0; j < n; j++)
+	y[j] += A[i*n+j] * x[i];
+  }
+  else {
+    for(int i = 0; i < n; i++) {
+      double sum = 0;
+      for(int j = 0; j < n; j++)
+	sum += A[i*n+j] * x[j];
+      y[i] = sum;
+    }
+  }
+}
+
+// As leaf_gemm, for float elements
+static void leaf_gemm_float(int n, float const * A, float const * B, bool transA, bool transB, float beta, float * C) {
+  if(CMatrix::USE_BLAS == 1) {
+    leaf_blas_begin();
+    char tA = transA ? 'T' : 'N';
+    char tB = transB ? 'T' : 'N';
+    float alpha = 1.0;
+    sgemm_(&tB, &tA, &n, &n, &n, &alpha,
+	   B, &n, A, &n,
+	   &beta, C, &n);
+  }
+  else {
+    // Plain loops, C(i,j) = sum over k of op(A)(i,k) * op(B)(k,j)
+    for(int i = 0; i < n; i++)
+      for(int j = 0; j < n; j++) {
+	float sum = 0;
+	for(int k = 0; k < n; k++)
+	  sum += (transA ? A[k*n+i] : A[i*n+k]) * (transB ? B[j*n+k] : B[k*n+j]);
+	C[i*n+j] = beta * C[i*n+j] + sum;
+      }
+  }
+}
+
+// Updated from several worker threads
+static std::atomic<size_t> leafMultiplyCount(0);
+
+static bool use_sgemm(CMatrix const & A, CMatrix const & B) {
+  return A.leafType == CMatrix::LEAF_FLOAT_SGEMM && B.leafType == CMatrix::LEAF_FLOAT_SGEMM;
+}
+
+void leaf_multiply(CMatrix const & A, CMatrix const & B, bool transA, bool transB, CMatrix & C) {
+  int n = A.n;
+  leafMultiplyCount++;
+  if(use_sgemm(A, B)) {
+    C.leafType = A.leafType;
+    C.elements.resize((n*n+1)/2);
+    leaf_gemm_float(n, A.floatElements(), B.floatElements(), transA, transB, 0, C.floatElements());
+    return;
+  }
+  LeafBuffer tmpA, tmpB;
+  C.leafType = CMatrix::LEAF_DOUBLE;
+  C.elements.resize(n*n);
+  leaf_multiply(n, A.getDoubleElements(tmpA), B.getDoubleElements(tmpB), transA, transB, &C.elements[0]);
+  C.setLeafType(A.leafType);
+}
+
+void leaf_multiply_add(CMatrix const & A, CMatrix const & B, CMatrix const & C, CMatrix & C_new) {
+  int n = A.n;
+  leafMultiplyCount++;
+  if(use_sgemm(A, B) && C.leafType == CMatrix::LEAF_FLOAT_SGEMM) {
+    C_new.leafType = C.leafType;
+    C_new.elements = C.elements;
+    leaf_gemm_float(n, A.floatElements(), B.floatElements(), false, false, 1, C_new.floatElements());
+    return;
+  }
+  LeafBuffer tmpA, tmpB, tmpC;
+  C_new.leafType = CMatrix::LEAF_DOUBLE;
+  C_new.elements.resize(n*n);
+  memcpy(&C_new.elements[0], C.getDoubleElements(tmpC), n*n*sizeof(double));
+  leaf_multiply_add(n, A.getDoubleElements(tmpA), B.getDoubleElements(tmpB), &C_new.elements[0]);
+  C_new.setLeafType(A.leafType);
+}
+
+size_t leaf_multiply_count() {
+  return leafMultiplyCount.load();
+}
+
+void leaf_multiply_reset_count() {
+  leafMultiplyCount.store(0);
+}
@@ -0,0 +1,51 @@
+#ifndef MATRIXLEAFKERNELS_HEADER
+#define MATRIXLEAFKERNELS_HEADER
+
+#include <cstddef>
+
+/* Kernels operating on the n x n element arrays of CMatrix leaves,
+   which are stored row-major. The block size is a runtime parameter;
+   only leaf_add and leaf_subtract dispatch common block sizes to
+   versions where n is a compile-time constant. The multiplies are not
+   specialized, they use BLAS, or the built-in SIMD kernel in
+   ../common/simd_gemm.c if CMatrix::USE_BLAS is 0, both of which
+   take n at runtime. */
+
+// C = op(A) * op(B), op(X) is X or X^T depending on the flag
+void leaf_multiply(int n, double const * A, double const * B, bool transA, bool transB, double * C);
+// C += A * B
+void leaf_multiply_add(int n, double const * A, double const * B, double * C);
+// Kernels for the symmetric matrix tasks, symmetric leaves have both triangles stored
+// C = S * G, or G * S if sideRight is true, S symmetric (dsymm)
+void leaf_symm(int n, double const * S, double const * G, bool sideRight, double * C);
+// C = A * A^T, or A^T * A if transpose is true (dsyrk), n^3 flops
+void leaf_syrk(int n, double const * A, bool transpose, double * C);
+// C = A + B
+void leaf_add(int n, double const * A, double const * B, double * C);
+// C = A - B
+void leaf_subtract(int n, double const * A, double const * B, double * C);
+/* Number of threads the BLAS library may use in each leaf dgemm call,
+   from the environment variable LEAF_BLAS_THREADS (default 1). It
+   is applied with openblas_set_num_threads if the linked BLAS is
+   OpenBLAS, otherwise the BLAS library's own default is used. Above
+   1 it needs an OpenBLAS built with OpenMP, so that worker threads
+   can call it at the same time, each with its own BLAS threads. */
+int leaf_blas_threads();
+// y = A * x, or y = A^T * x if transpose is true
+void leaf_matvec(int n, double const * A, double const * x, bool transpose, double * y);
+
+/* Multiplies for CMatrix leaves of any leaf type. Float leaves are
+   multiplied with sgemm if both are LEAF_FLOAT_SGEMM, otherwise
+   converted to double and multiplied with dgemm. The result gets the
+   leaf type of A, n and blockSize of C are set by the caller. */
+struct CMatrix;
+// C = op(A) * op(B)
+void leaf_multiply(CMatrix const & A, CMatrix const & B, bool transA, bool transB, CMatrix & C);
+// C_new = C + A * B
+void leaf_multiply_add(CMatrix const & A, CMatrix const & B, CMatrix const & C, CMatrix & C_new);
+/* Number of calls to the two CMatrix multiplies above in this process,
+   i.e. leaf products actually computed, from all threads. */
+size_t leaf_multiply_count();
+void leaf_multiply_reset_count();
+
+#endif
@@ -1,66 +1,73 @@
 #include "MatrixMultiply.h"
+#include "TaskProfile.h"
 #include "MatrixAdd.h"
+#include "MatrixLeafKernels.h"
 #include "CreateMatrixFromIds.h"
-#include <cstring>
-
-extern "C"
-void dgemm_(const char *ta,const char *tb,
-	    const int *n, const int *k, const int *l,
-	    const double *alpha,const double *A,const int *lda,
-	    const double *B, const int *ldb,
-	    const double *beta, double *C, const int *ldc);
+#include "CreateMatrixFromIdsWithNorms.h"
 
 CHT_TASK_TYPE_IMPLEMENTATION((MatrixMultiply));
-cht::ID MatrixMultiply::execute(CMatrix const & A, CMatrix const & B) {
+cht::ID MatrixMultiply::execute(CMatrix const & A, CMatrix const & B, CDouble const & tolerance,
+				CInt const & transA, CInt const & transB) {
+  TaskProfileScope profile("MatrixMultiply", A.n);
   int nA = A.n;
   int nB = B.n;
-  if(nA != nB || nA < CMatrix::BLOCK_SIZE)
-    throw std::runtime_error("Error in MatrixMultiply::execute: (nA != nB || nA < CMatrix::BLOCK_SIZE).");
+  if(nA != nB || A.blockSize != B.blockSize || nA < A.blockSize)
+    throw std::runtime_error("Error in MatrixMultiply::execute: (nA != nB || A.blockSize != B.blockSize || nA < A.blockSize).");
+  if(A.symmetric || B.symmetric)
+    throw std::runtime_error("Error in MatrixMultiply::execute: symmetric input, use the symmetric matrix tasks.");
+  if(tolerance > 0 && !(A.hasNorms() && B.hasNorms()))
+    throw std::runtime_error("Error in MatrixMultiply::execute: screening needs matrices with norms, see CMatrix::hasNorms.");
   int n = nA;
-  if(n <= CMatrix::BLOCK_SIZE) {
-    assert(n == CMatrix::BLOCK_SIZE);
+  /* Only the top level is screened here, children are screened before
+     their tasks are registered. Unknown norms are -1, so screening is
+     only done for a positive tolerance, when the norms are known. */
+  if(tolerance > 0 && A.norm * B.norm < tolerance)
+    return cht::CHUNK_ID_NULL;
+  if(A.isLeaf()) {
+    assert(n == A.blockSize);
     // Lowest level
     CMatrix* C = new CMatrix();
     C->n = n;
-    C->elements.resize(n*n);
-    memset(&C->elements[0], 0, n*n*sizeof(double));
-    if(CMatrix::USE_BLAS == 1) {
-      // Use BLAS
-      double alpha = 1.0;
-      double beta = 0;
-      dgemm_("T", "T", &n, &n, &n, &alpha,
-	     &A.elements[0], &n, &B.elements[0], &n,
-	     &beta, &C->elements[0], &n);
-    }
-    else {
-      // Do not use BLAS
-      for(int i = 0; i < n; i++)
-	for(int k = 0; k < n; k++)
-	  for(int j = 0; j < n; j++) {
-	    double Aik = A.elements[i*n+k];
-	    double Bkj = B.elements[k*n+j];
-	    C->elements[j*n+i] += Aik * Bkj;
-	  }
-    } // end else not using BLAS
+    C->blockSize = A.blockSize;
+    leaf_multiply(A, B, transA != 0, transB != 0, *C);
+    profile.addFlops(2.0*n*n*n);
+    C->setNormFromElements();
     return registerChunk(C, cht::persistent);
   }
   else {
-    for(int i = 0; i < 4; i++) {
-      if(A.children[i] == cht::CHUNK_ID_NULL)
-	throw std::runtime_error("Error in MatrixMultiply::execute: CHUNK_ID_NULL found for A.");
-      if(B.children[i] == cht::CHUNK_ID_NULL)
-	throw std::runtime_error("Error in MatrixMultiply::execute: CHUNK_ID_NULL found for B.");
-    }
-    // Not lowest level
+    // Not lowest level. C_ij = sum over k of op(A)_ik * op(B)_kj, where
+    // op(A)_ik is A_ik, or A_ki^T if transposed, and likewise for B.
+    // CHUNK_ID_NULL children are all-zero matrices so any product
+    // involving them is skipped, and so are products whose norm
+    // product is below the tolerance.
     cht::ID childTaskIDs[4];
     for(int i = 0; i < 2; i++)
       for(int j = 0; j < 2; j++) {
 	cht::ID childTaskIDsForSum[2];
-	for(int k = 0; k < 2; k++)
-	  childTaskIDsForSum[k] = registerTask<MatrixMultiply>(A.children[i*2+k], B.children[k*2+j]);
-	childTaskIDs[j*2+i] = registerTask<MatrixAdd>(childTaskIDsForSum[0], childTaskIDsForSum[1]);
+	int nProducts = 0;
+	for(int k = 0; k < 2; k++) {
+	  int childIdxA = transA ? k*2+i : i*2+k;
+	  int childIdxB = transB ? j*2+k : k*2+j;
+	  if(A.children[childIdxA] == cht::CHUNK_ID_NULL || B.children[childIdxB] == cht::CHUNK_ID_NULL)
+	    continue;
+	  if(tolerance > 0 && A.childNorms[childIdxA] * B.childNorms[childIdxB] < tolerance)
+	    continue;
+	  childTaskIDsForSum[nProducts] = registerTask<MatrixMultiply>(A.children[childIdxA], B.children[childIdxB], getInputChunkID(tolerance),
+								       getInputChunkID(transA), getInputChunkID(transB));
+	  nProducts++;
+	}
+	if(nProducts == 0)
+	  childTaskIDs[i*2+j] = cht::CHUNK_ID_NULL;
+	else if(nProducts == 1)
+	  childTaskIDs[i*2+j] = childTaskIDsForSum[0];
+	else
+	  childTaskIDs[i*2+j] = registerTask<MatrixAdd>(childTaskIDsForSum[0], childTaskIDsForSum[1]);
       }
     cht::ChunkID cid_n = registerChunk( new CInt(n) );
-    return registerTask<CreateMatrixFromIds>(cid_n, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(A.blockSize) );
+    // The product has norms if the factors have, so that it can be screened in turn
+    if(A.hasNorms() && B.hasNorms())
+      return registerTask<CreateMatrixFromIdsWithNorms>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+    return registerTask<CreateMatrixFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
   }
 } // end execute
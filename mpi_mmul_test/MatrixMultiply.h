@@ -1,9 +1,19 @@
 #include "chunks_and_tasks.h"
 #include "CMatrix.h"
+#include "CDouble.h"
+#include "CInt.h"
 
+/* Computes op(A) * op(B), where op(X) is X^T if the corresponding
+   flag is nonzero and X otherwise. Transposes are never formed: the
+   recursion picks the children of A^T and B^T by swapping indices and
+   the leaf gemm gets the transpose flags. Products of sub-matrices
+   whose norms multiply to less than the tolerance are skipped
+   (screened), which gives an error of at most the sum of the skipped
+   norm products in the Frobenius norm. Tolerance 0 gives the exact
+   product. */
 struct MatrixMultiply: public cht::Task {
-  cht::ID execute(CMatrix const &, CMatrix const &);
-  CHT_TASK_INPUT((CMatrix, CMatrix));
+  cht::ID execute(CMatrix const &, CMatrix const &, CDouble const &, CInt const &, CInt const &);
+  CHT_TASK_INPUT((CMatrix, CMatrix, CDouble, CInt, CInt));
   CHT_TASK_OUTPUT((CMatrix));
   CHT_TASK_TYPE_DECLARATION;
 };
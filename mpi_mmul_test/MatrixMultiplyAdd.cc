@@ -0,0 +1,48 @@
+#include "MatrixMultiplyAdd.h"
+#include "TaskProfile.h"
+#include "MatrixMultiplyAddNonNull.h"
+#include "MatrixLeafKernels.h"
+#include "CreateMatrixFromIds.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixMultiplyAdd));
+cht::ID MatrixMultiplyAdd::execute(CMatrix const & A, CMatrix const & B, cht::ChunkID const & C) {
+  TaskProfileScope profile("MatrixMultiplyAdd", A.n);
+  if(C != cht::CHUNK_ID_NULL)
+    return registerTask<MatrixMultiplyAddNonNull>(getInputChunkID(A), getInputChunkID(B), C, cht::persistent);
+  // C is zero, so compute A * B
+  int nA = A.n;
+  int nB = B.n;
+  if(nA != nB || A.blockSize != B.blockSize || nA < A.blockSize)
+    throw std::runtime_error("Error in MatrixMultiplyAdd::execute: (nA != nB || A.blockSize != B.blockSize || nA < A.blockSize).");
+  if(A.symmetric || B.symmetric)
+    throw std::runtime_error("Error in MatrixMultiplyAdd::execute: symmetric input, use the symmetric matrix tasks.");
+  int n = nA;
+  if(A.isLeaf()) {
+    // Lowest level
+    CMatrix* C_new = new CMatrix();
+    C_new->n = n;
+    C_new->blockSize = A.blockSize;
+    leaf_multiply(A, B, false, false, *C_new);
+    profile.addFlops(2.0*n*n*n);
+    C_new->setNormFromElements();
+    return registerChunk(C_new, cht::persistent);
+  }
+  else {
+    // Not lowest level. Each child of the result is computed by a
+    // chain of multiply-add tasks, products with zero blocks are skipped.
+    cht::ID childTaskIDs[4];
+    for(int i = 0; i < 2; i++)
+      for(int j = 0; j < 2; j++) {
+	cht::ID sum = cht::CHUNK_ID_NULL;
+	for(int k = 0; k < 2; k++) {
+	  if(A.children[i*2+k] == cht::CHUNK_ID_NULL || B.children[k*2+j] == cht::CHUNK_ID_NULL)
+	    continue;
+	  sum = registerTask<MatrixMultiplyAdd>(A.children[i*2+k], B.children[k*2+j], sum);
+	}
+	childTaskIDs[i*2+j] = sum;
+      }
+    cht::ChunkID cid_n = registerChunk( new CInt(n) );
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(A.blockSize) );
+    return registerTask<CreateMatrixFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+  }
+} // end execute
@@ -0,0 +1,12 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+
+/* Computes C + A * B without materializing the product A * B. C may
+   be CHUNK_ID_NULL, meaning zero. If C is nonzero the work is done by
+   MatrixMultiplyAddNonNull. */
+struct MatrixMultiplyAdd: public cht::Task {
+  cht::ID execute(CMatrix const &, CMatrix const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((CMatrix, CMatrix, cht::ChunkID));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
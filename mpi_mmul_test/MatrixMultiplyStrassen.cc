@@ -0,0 +1,11 @@
+#include "MatrixMultiplyStrassen.h"
+#include "TaskProfile.h"
+#include "MatrixMultiplyStrassenNonNull.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixMultiplyStrassen));
+cht::ID MatrixMultiplyStrassen::execute(cht::ChunkID const & A, cht::ChunkID const & B, cht::ChunkID const & depth) {
+  TaskProfileScope profile("MatrixMultiplyStrassen", 0);
+  if(A == cht::CHUNK_ID_NULL || B == cht::CHUNK_ID_NULL)
+    return cht::CHUNK_ID_NULL;
+  return registerTask<MatrixMultiplyStrassenNonNull>(A, B, depth, cht::persistent);
+} // end execute
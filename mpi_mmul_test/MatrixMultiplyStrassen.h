@@ -0,0 +1,14 @@
+#include "chunks_and_tasks.h"
+#include "CInt.h"
+#include "CMatrix.h"
+
+/* Computes A * B using the Strassen-Winograd algorithm (7 multiplies
+   and 15 additions per level) for the given number of levels, below
+   that the classic MatrixMultiply is used. Either of A and B may be
+   CHUNK_ID_NULL. The work is done by MatrixMultiplyStrassenNonNull. */
+struct MatrixMultiplyStrassen: public cht::Task {
+  cht::ID execute(cht::ChunkID const &, cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((cht::ChunkID, cht::ChunkID, cht::ChunkID));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
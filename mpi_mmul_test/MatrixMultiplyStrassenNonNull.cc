@@ -0,0 +1,61 @@
+#include "MatrixMultiplyStrassenNonNull.h"
+#include "TaskProfile.h"
+#include "MatrixMultiplyStrassen.h"
+#include "MatrixMultiply.h"
+#include "MatrixAdd.h"
+#include "MatrixSubtract.h"
+#include "CreateMatrixFromIds.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixMultiplyStrassenNonNull));
+cht::ID MatrixMultiplyStrassenNonNull::execute(CMatrix const & A, CMatrix const & B, CInt const & depth) {
+  TaskProfileScope profile("MatrixMultiplyStrassenNonNull", A.n);
+  int nA = A.n;
+  int nB = B.n;
+  if(nA != nB || A.blockSize != B.blockSize || nA < A.blockSize)
+    throw std::runtime_error("Error in MatrixMultiplyStrassenNonNull::execute: (nA != nB || A.blockSize != B.blockSize || nA < A.blockSize).");
+  if(A.symmetric || B.symmetric)
+    throw std::runtime_error("Error in MatrixMultiplyStrassenNonNull::execute: symmetric input, use the symmetric matrix tasks.");
+  int n = nA;
+  if(depth <= 0 || A.isLeaf()) {
+    // Below the Strassen cutoff, use the classic algorithm, without screening
+    cht::ChunkID cid_tolerance = registerChunk( new CDouble(0) );
+    cht::ChunkID cid_noTranspose = registerChunk( new CInt(0) );
+    return registerTask<MatrixMultiply>(getInputChunkID(A), getInputChunkID(B), cid_tolerance, cid_noTranspose, cid_noTranspose, cht::persistent);
+  }
+  // Not lowest level, one Strassen-Winograd step. Names follow the
+  // usual block notation, e.g. A12 is A.children[0*2+1].
+  cht::ChunkID const & A11 = A.children[0];
+  cht::ChunkID const & A12 = A.children[1];
+  cht::ChunkID const & A21 = A.children[2];
+  cht::ChunkID const & A22 = A.children[3];
+  cht::ChunkID const & B11 = B.children[0];
+  cht::ChunkID const & B12 = B.children[1];
+  cht::ChunkID const & B21 = B.children[2];
+  cht::ChunkID const & B22 = B.children[3];
+  cht::ID S1 = registerTask<MatrixAdd>(A21, A22);
+  cht::ID S2 = registerTask<MatrixSubtract>(S1, A11);
+  cht::ID S3 = registerTask<MatrixSubtract>(A11, A21);
+  cht::ID S4 = registerTask<MatrixSubtract>(A12, S2);
+  cht::ID T1 = registerTask<MatrixSubtract>(B12, B11);
+  cht::ID T2 = registerTask<MatrixSubtract>(B22, T1);
+  cht::ID T3 = registerTask<MatrixSubtract>(B22, B12);
+  cht::ID T4 = registerTask<MatrixSubtract>(T2, B21);
+  cht::ChunkID cid_depth = registerChunk( new CInt(depth-1) );
+  cht::ID M1 = registerTask<MatrixMultiplyStrassen>(A11, B11, cid_depth);
+  cht::ID M2 = registerTask<MatrixMultiplyStrassen>(A12, B21, cid_depth);
+  cht::ID M3 = registerTask<MatrixMultiplyStrassen>(S4, B22, cid_depth);
+  cht::ID M4 = registerTask<MatrixMultiplyStrassen>(A22, T4, cid_depth);
+  cht::ID M5 = registerTask<MatrixMultiplyStrassen>(S1, T1, cid_depth);
+  cht::ID M6 = registerTask<MatrixMultiplyStrassen>(S2, T2, cid_depth);
+  cht::ID M7 = registerTask<MatrixMultiplyStrassen>(S3, T3, cid_depth);
+  cht::ID U1 = registerTask<MatrixAdd>(M1, M2); // C11
+  cht::ID U2 = registerTask<MatrixAdd>(M1, M6);
+  cht::ID U3 = registerTask<MatrixAdd>(U2, M7);
+  cht::ID U4 = registerTask<MatrixAdd>(U2, M5);
+  cht::ID U5 = registerTask<MatrixAdd>(U4, M3); // C12
+  cht::ID U6 = registerTask<MatrixSubtract>(U3, M4); // C21
+  cht::ID U7 = registerTask<MatrixAdd>(U3, M5); // C22
+  cht::ChunkID cid_n = registerChunk( new CInt(n) );
+  cht::ChunkID cid_blockSize = registerChunk( new CInt(A.blockSize) );
+  return registerTask<CreateMatrixFromIds>(cid_n, cid_blockSize, U1, U5, U6, U7, cht::persistent);
+} // end execute
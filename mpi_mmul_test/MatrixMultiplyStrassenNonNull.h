@@ -0,0 +1,10 @@
+#include "chunks_and_tasks.h"
+#include "CInt.h"
+#include "CMatrix.h"
+
+struct MatrixMultiplyStrassenNonNull: public cht::Task {
+  cht::ID execute(CMatrix const &, CMatrix const &, CInt const &);
+  CHT_TASK_INPUT((CMatrix, CMatrix, CInt));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,79 @@
+#include "MatrixMultiplySymm.h"
+#include "TaskProfile.h"
+#include "MatrixMultiply.h"
+#include "MatrixAdd.h"
+#include "MatrixLeafKernels.h"
+#include "CreateMatrixFromIds.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixMultiplySymm));
+cht::ID MatrixMultiplySymm::execute(CMatrix const & S, CMatrix const & G, CInt const & sideRight) {
+  TaskProfileScope profile("MatrixMultiplySymm", S.n);
+  int n = S.n;
+  if(n != G.n || S.blockSize != G.blockSize || n < S.blockSize)
+    throw std::runtime_error("Error in MatrixMultiplySymm::execute: (S.n != G.n || S.blockSize != G.blockSize || S.n < S.blockSize).");
+  if(!S.symmetric || G.symmetric)
+    throw std::runtime_error("Error in MatrixMultiplySymm::execute: S must be symmetric and G general.");
+  if(S.isLeaf()) {
+    // Lowest level
+    CMatrix* C = new CMatrix();
+    C->n = n;
+    C->blockSize = S.blockSize;
+    C->elements.resize(n*n);
+    LeafBuffer tmpS, tmpG;
+    leaf_symm(n, S.getDoubleElements(tmpS), G.getDoubleElements(tmpG), sideRight != 0, &C->elements[0]);
+    C->setLeafType(S.leafType);
+    profile.addFlops(2.0*n*n*n);
+    C->setNormFromElements();
+    return registerChunk(C, cht::persistent);
+  }
+  else {
+    /* Not lowest level. With S = [S11 S12; S12^T S22] the diagonal
+       blocks give symmetric products again, and the off-diagonal
+       block gives general products with S12 or S12^T. */
+    // Transpose flags 0 and 1 and tolerance 0 for MatrixMultiply, registered when first needed
+    cht::ChunkID cid_flag[2] = {cht::CHUNK_ID_NULL, cht::CHUNK_ID_NULL};
+    cht::ChunkID cid_tolerance = cht::CHUNK_ID_NULL;
+    cht::ID childTaskIDs[4];
+    for(int i = 0; i < 2; i++)
+      for(int j = 0; j < 2; j++) {
+	cht::ID childTaskIDsForSum[2];
+	int nProducts = 0;
+	for(int k = 0; k < 2; k++) {
+	  // Symmetric block S_ab and the general block it multiplies
+	  int a = sideRight ? k : i;
+	  int b = sideRight ? j : k;
+	  cht::ChunkID cid_G = sideRight ? G.children[i*2+k] : G.children[k*2+j];
+	  cht::ChunkID cid_S = a == b ? S.children[a*2+a] : S.children[1];
+	  if(cid_S == cht::CHUNK_ID_NULL || cid_G == cht::CHUNK_ID_NULL)
+	    continue;
+	  cht::ID product;
+	  if(a == b)
+	    product = registerTask<MatrixMultiplySymm>(cid_S, cid_G, getInputChunkID(sideRight));
+	  else {
+	    int transS = a < b ? 0 : 1;
+	    for(int t = 0; t <= transS; t++)
+	      if(cid_flag[t] == cht::CHUNK_ID_NULL)
+		cid_flag[t] = registerChunk( new CInt(t) );
+	    if(cid_tolerance == cht::CHUNK_ID_NULL)
+	      cid_tolerance = registerChunk( new CDouble(0) );
+	    if(sideRight)
+	      // G_i0 * S12 or G_i1 * S12^T
+	      product = registerTask<MatrixMultiply>(cid_G, cid_S, cid_tolerance, cid_flag[0], cid_flag[transS]);
+	    else
+	      // S12 * G_1j or S12^T * G_0j
+	      product = registerTask<MatrixMultiply>(cid_S, cid_G, cid_tolerance, cid_flag[transS], cid_flag[0]);
+	  }
+	  childTaskIDsForSum[nProducts++] = product;
+	}
+	if(nProducts == 0)
+	  childTaskIDs[i*2+j] = cht::CHUNK_ID_NULL;
+	else if(nProducts == 1)
+	  childTaskIDs[i*2+j] = childTaskIDsForSum[0];
+	else
+	  childTaskIDs[i*2+j] = registerTask<MatrixAdd>(childTaskIDsForSum[0], childTaskIDsForSum[1]);
+      }
+    cht::ChunkID cid_n = registerChunk( new CInt(n) );
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(S.blockSize) );
+    return registerTask<CreateMatrixFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+  }
+} // end execute
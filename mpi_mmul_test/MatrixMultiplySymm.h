@@ -0,0 +1,14 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+#include "CInt.h"
+
+/* Computes C = S * G, or C = G * S if the third input is nonzero,
+   where S is symmetric (upper block triangle stored) and G general.
+   C is general and stored in the normal layout. The leaf kernel is
+   dsymm. */
+struct MatrixMultiplySymm: public cht::Task {
+  cht::ID execute(CMatrix const &, CMatrix const &, CInt const &);
+  CHT_TASK_INPUT((CMatrix, CMatrix, CInt));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
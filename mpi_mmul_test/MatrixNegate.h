@@ -0,0 +1,9 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+
+struct MatrixNegate: public cht::Task {
+  cht::ID execute(CMatrix const &);
+  CHT_TASK_INPUT((CMatrix));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,61 @@
+#include "MatrixScale.h"
+#include "TaskProfile.h"
+#include "CreateMatrixFromIds.h"
+#include "CreateMatrixFromIdsAndNorms.h"
+#include "CreateSymmMatrixFromIds.h"
+#include "CreateSymmMatrixFromIdsAndNorms.h"
+#include "CVector.h"
+#include <cmath>
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixScale));
+cht::ID MatrixScale::execute(CMatrix const & A, CDouble const & alpha) {
+  TaskProfileScope profile("MatrixScale", A.n);
+  int n = A.n;
+  if(A.isLeaf()) {
+    // Lowest level
+    CMatrix* C = new CMatrix();
+    C->n = n;
+    C->blockSize = A.blockSize;
+    C->elements.resize(n*n);
+    double a = alpha;
+    LeafBuffer tmpA;
+    double const * elementsA = A.getDoubleElements(tmpA);
+    for(int i = 0; i < n*n; i++)
+      C->elements[i] = a * elementsA[i];
+    C->symmetric = A.symmetric;
+    C->setLeafType(A.leafType);
+    C->setNormFromElements();
+    return registerChunk(C, cht::persistent);
+  }
+  else {
+    // Not lowest level. Zero children stay zero, and so does the
+    // unstored lower block of a symmetric matrix.
+    cht::ID childTaskIDs[4];
+    for(int i = 0; i < 4; i++) {
+      if(A.children[i] == cht::CHUNK_ID_NULL)
+	childTaskIDs[i] = cht::CHUNK_ID_NULL;
+      else
+	childTaskIDs[i] = registerTask<MatrixScale>(A.children[i], getInputChunkID(alpha));
+    }
+    cht::ChunkID cid_n = registerChunk( new CInt(n) );
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(A.blockSize) );
+    if(A.hasNorms()) {
+      // The norms scale with |alpha|, so the children need not be fetched for them
+      CVector* childNorms = new CVector();
+      childNorms->n = 4;
+      childNorms->blockSize = 4;
+      childNorms->elements.resize(4);
+      for(int i = 0; i < 4; i++)
+	childNorms->elements[i] = std::fabs((double)alpha) * A.childNorms[i];
+      cht::ChunkID cid_childNorms = registerChunk(childNorms);
+      if(A.symmetric)
+	return registerTask<CreateSymmMatrixFromIdsAndNorms>(cid_n, cid_blockSize, cid_childNorms,
+							     childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+      return registerTask<CreateMatrixFromIdsAndNorms>(cid_n, cid_blockSize, cid_childNorms,
+						       childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+    }
+    if(A.symmetric)
+      return registerTask<CreateSymmMatrixFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+    return registerTask<CreateMatrixFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], childTaskIDs[3], cht::persistent);
+  }
+} // end execute
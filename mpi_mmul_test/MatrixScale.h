@@ -0,0 +1,11 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+#include "CDouble.h"
+
+/* Computes alpha * A. */
+struct MatrixScale: public cht::Task {
+  cht::ID execute(CMatrix const &, CDouble const &);
+  CHT_TASK_INPUT((CMatrix, CDouble));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
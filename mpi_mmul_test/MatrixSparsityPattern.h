@@ -0,0 +1,58 @@
+#ifndef MATRIXSPARSITYPATTERN_HEADER
+#define MATRIXSPARSITYPATTERN_HEADER
+
+/* Block sparsity patterns used when creating test matrices. The
+   pattern decides, for each leaf block (blockIdx1, blockIdx2), whether
+   that block is nonzero. All-zero sub-matrices are not stored at all,
+   they are represented by cht::CHUNK_ID_NULL in the quad-tree. */
+
+const int SPARSITY_PATTERN_DENSE = 0;
+// Banded: block (i,j) nonzero if |i-j| <= param.
+const int SPARSITY_PATTERN_BANDED = 1;
+// Random: each block nonzero with probability param percent.
+const int SPARSITY_PATTERN_RANDOM = 2;
+
+static inline bool blockIsNonZero(int patternType, int patternParam, int blockIdx1, int blockIdx2) {
+  if(patternType == SPARSITY_PATTERN_BANDED) {
+    int diff = blockIdx1 - blockIdx2;
+    if(diff < 0)
+      diff = -diff;
+    return diff <= patternParam;
+  }
+  else if(patternType == SPARSITY_PATTERN_RANDOM) {
+    // Simple integer hash so that the pattern is the same on all
+    // processes without any communication.
+    unsigned int h = (unsigned int)blockIdx1 * 2654435761u ^ (unsigned int)blockIdx2 * 40503u;
+    h ^= h >> 13;
+    h *= 1274126177u;
+    h ^= h >> 16;
+    return (int)(h % 100) < patternParam;
+  }
+  else
+    return true;
+}
+
+/* Returns true if any leaf block in the nBlocks x nBlocks region
+   starting at block (blockIdx1, blockIdx2) is nonzero. */
+static inline bool blockRegionIsNonZero(int patternType, int patternParam, int blockIdx1, int blockIdx2, int nBlocks) {
+  if(patternType == SPARSITY_PATTERN_BANDED) {
+    // Smallest |i-j| over the region
+    int minDiff = 0;
+    if(blockIdx2 - (blockIdx1 + nBlocks - 1) > 0)
+      minDiff = blockIdx2 - (blockIdx1 + nBlocks - 1);
+    if(blockIdx1 - (blockIdx2 + nBlocks - 1) > 0)
+      minDiff = blockIdx1 - (blockIdx2 + nBlocks - 1);
+    return minDiff <= patternParam;
+  }
+  else if(patternType == SPARSITY_PATTERN_RANDOM) {
+    for(int i = 0; i < nBlocks; i++)
+      for(int j = 0; j < nBlocks; j++)
+	if(blockIsNonZero(patternType, patternParam, blockIdx1+i, blockIdx2+j))
+	  return true;
+    return false;
+  }
+  else
+    return true;
+}
+
+#endif
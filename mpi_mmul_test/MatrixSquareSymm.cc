@@ -0,0 +1,73 @@
+#include "MatrixSquareSymm.h"
+#include "TaskProfile.h"
+#include "MatrixSyrk.h"
+#include "MatrixMultiplySymm.h"
+#include "MatrixAdd.h"
+#include "MatrixLeafKernels.h"
+#include "CreateSymmMatrixFromIds.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixSquareSymm));
+cht::ID MatrixSquareSymm::execute(CMatrix const & S) {
+  TaskProfileScope profile("MatrixSquareSymm", S.n);
+  int n = S.n;
+  if(n < S.blockSize)
+    throw std::runtime_error("Error in MatrixSquareSymm::execute: (S.n < S.blockSize).");
+  if(!S.symmetric)
+    throw std::runtime_error("Error in MatrixSquareSymm::execute: S is not symmetric.");
+  if(S.isLeaf()) {
+    // Lowest level, S * S = S * S^T
+    CMatrix* C = new CMatrix();
+    C->n = n;
+    C->blockSize = S.blockSize;
+    C->symmetric = 1;
+    C->elements.resize(n*n);
+    LeafBuffer tmpS;
+    leaf_syrk(n, S.getDoubleElements(tmpS), false, &C->elements[0]);
+    C->setLeafType(S.leafType);
+    profile.addFlops((double)n*n*n);
+    C->setNormFromElements();
+    return registerChunk(C, cht::persistent);
+  }
+  else {
+    /* Not lowest level. With S = [P Q; Q^T R]:
+       C11 = P * P + Q * Q^T
+       C12 = P * Q + Q * R
+       C22 = Q^T * Q + R * R
+       Products with zero blocks are skipped. */
+    cht::ChunkID P = S.children[0];
+    cht::ChunkID Q = S.children[1];
+    cht::ChunkID R = S.children[3];
+    cht::ChunkID cid_0 = cht::CHUNK_ID_NULL;
+    cht::ChunkID cid_1 = cht::CHUNK_ID_NULL;
+    if(Q != cht::CHUNK_ID_NULL) {
+      cid_0 = registerChunk( new CInt(0) );
+      cid_1 = registerChunk( new CInt(1) );
+    }
+    cht::ID terms[3][2];
+    int nTerms[3] = {0, 0, 0};
+    if(P != cht::CHUNK_ID_NULL)
+      terms[0][nTerms[0]++] = registerTask<MatrixSquareSymm>(P);
+    if(Q != cht::CHUNK_ID_NULL) {
+      terms[0][nTerms[0]++] = registerTask<MatrixSyrk>(Q, cid_0);
+      terms[2][nTerms[2]++] = registerTask<MatrixSyrk>(Q, cid_1);
+      if(P != cht::CHUNK_ID_NULL)
+	terms[1][nTerms[1]++] = registerTask<MatrixMultiplySymm>(P, Q, cid_0);
+      if(R != cht::CHUNK_ID_NULL)
+	terms[1][nTerms[1]++] = registerTask<MatrixMultiplySymm>(R, Q, cid_1);
+    }
+    if(R != cht::CHUNK_ID_NULL)
+      terms[2][nTerms[2]++] = registerTask<MatrixSquareSymm>(R);
+    cht::ID childTaskIDs[3];
+    for(int b = 0; b < 3; b++) {
+      if(nTerms[b] == 0)
+	childTaskIDs[b] = cht::CHUNK_ID_NULL;
+      else if(nTerms[b] == 1)
+	childTaskIDs[b] = terms[b][0];
+      else
+	childTaskIDs[b] = registerTask<MatrixAdd>(terms[b][0], terms[b][1]);
+    }
+    cht::ChunkID cid_n = registerChunk( new CInt(n) );
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(S.blockSize) );
+    return registerTask<CreateSymmMatrixFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[2], cht::persistent);
+  }
+} // end execute
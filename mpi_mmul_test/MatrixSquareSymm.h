@@ -0,0 +1,16 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+
+/* Computes C = S * S for a symmetric matrix S, for example in
+   density matrix purification. S and C are stored as their upper
+   block triangles, see CMatrix::symmetric, and only the upper block
+   triangle of C is computed. Since S * S = S * S^T the leaf kernel
+   is dsyrk, and the off-diagonal blocks use MatrixSyrk and
+   MatrixMultiplySymm, so storage and work are both about half of
+   those of a general multiply. */
+struct MatrixSquareSymm: public cht::Task {
+  cht::ID execute(CMatrix const &);
+  CHT_TASK_INPUT((CMatrix));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
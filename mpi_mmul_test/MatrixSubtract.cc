@@ -0,0 +1,16 @@
+#include "MatrixSubtract.h"
+#include "TaskProfile.h"
+#include "MatrixSubtractNonNull.h"
+#include "MatrixNegate.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixSubtract));
+cht::ID MatrixSubtract::execute(cht::ChunkID const & A, cht::ChunkID const & B) {
+  TaskProfileScope profile("MatrixSubtract", 0);
+  if(A == cht::CHUNK_ID_NULL && B == cht::CHUNK_ID_NULL)
+    return cht::CHUNK_ID_NULL;
+  if(B == cht::CHUNK_ID_NULL)
+    return copyChunk(A);
+  if(A == cht::CHUNK_ID_NULL)
+    return registerTask<MatrixNegate>(B, cht::persistent);
+  return registerTask<MatrixSubtractNonNull>(A, B, cht::persistent);
+} // end execute
@@ -0,0 +1,12 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+
+/* Computes A - B where either of A and B may be CHUNK_ID_NULL,
+   meaning an all-zero matrix. The work is done by
+   MatrixSubtractNonNull, or by MatrixNegate if A is zero. */
+struct MatrixSubtract: public cht::Task {
+  cht::ID execute(cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((cht::ChunkID, cht::ChunkID));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,67 @@
+#include "MatrixSyrk.h"
+#include "TaskProfile.h"
+#include "MatrixMultiply.h"
+#include "MatrixAdd.h"
+#include "MatrixLeafKernels.h"
+#include "CreateSymmMatrixFromIds.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixSyrk));
+cht::ID MatrixSyrk::execute(CMatrix const & A, CInt const & transpose) {
+  TaskProfileScope profile("MatrixSyrk", A.n);
+  int n = A.n;
+  if(n < A.blockSize)
+    throw std::runtime_error("Error in MatrixSyrk::execute: (A.n < A.blockSize).");
+  if(A.symmetric)
+    throw std::runtime_error("Error in MatrixSyrk::execute: symmetric input, use MatrixSquareSymm.");
+  if(A.isLeaf()) {
+    // Lowest level
+    CMatrix* C = new CMatrix();
+    C->n = n;
+    C->blockSize = A.blockSize;
+    C->symmetric = 1;
+    C->elements.resize(n*n);
+    LeafBuffer tmpA;
+    leaf_syrk(n, A.getDoubleElements(tmpA), transpose != 0, &C->elements[0]);
+    C->setLeafType(A.leafType);
+    profile.addFlops((double)n*n*n);
+    C->setNormFromElements();
+    return registerChunk(C, cht::persistent);
+  }
+  else {
+    /* Not lowest level. With X_rk = A_rk, or A_kr if transposed,
+       C_rs = sum over k of X_rk * X_sk^T. The diagonal blocks are
+       symmetric products again, only C_12 of the off-diagonal ones is
+       computed. */
+    cht::ChunkID cid_notTranspose = cht::CHUNK_ID_NULL;
+    cht::ChunkID cid_tolerance = cht::CHUNK_ID_NULL;
+    cht::ID childTaskIDs[4] = {cht::CHUNK_ID_NULL, cht::CHUNK_ID_NULL, cht::CHUNK_ID_NULL, cht::CHUNK_ID_NULL};
+    for(int r = 0; r < 2; r++)
+      for(int s = r; s < 2; s++) {
+	cht::ID childTaskIDsForSum[2];
+	int nProducts = 0;
+	for(int k = 0; k < 2; k++) {
+	  cht::ChunkID cid_X_r = transpose ? A.children[k*2+r] : A.children[r*2+k];
+	  cht::ChunkID cid_X_s = transpose ? A.children[k*2+s] : A.children[s*2+k];
+	  if(cid_X_r == cht::CHUNK_ID_NULL || cid_X_s == cht::CHUNK_ID_NULL)
+	    continue;
+	  if(r == s)
+	    childTaskIDsForSum[nProducts++] = registerTask<MatrixSyrk>(cid_X_r, getInputChunkID(transpose));
+	  else {
+	    if(cid_notTranspose == cht::CHUNK_ID_NULL) {
+	      cid_notTranspose = registerChunk( new CInt(transpose ? 0 : 1) );
+	      cid_tolerance = registerChunk( new CDouble(0) );
+	    }
+	    // X_1k * X_2k^T is A_1k * A_2k^T, or A_k1^T * A_k2 if transposed
+	    childTaskIDsForSum[nProducts++] = registerTask<MatrixMultiply>(cid_X_r, cid_X_s, cid_tolerance, getInputChunkID(transpose), cid_notTranspose);
+	  }
+	}
+	if(nProducts == 1)
+	  childTaskIDs[r*2+s] = childTaskIDsForSum[0];
+	else if(nProducts == 2)
+	  childTaskIDs[r*2+s] = registerTask<MatrixAdd>(childTaskIDsForSum[0], childTaskIDsForSum[1]);
+      }
+    cht::ChunkID cid_n = registerChunk( new CInt(n) );
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(A.blockSize) );
+    return registerTask<CreateSymmMatrixFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], childTaskIDs[3], cht::persistent);
+  }
+} // end execute
@@ -0,0 +1,15 @@
+#include "chunks_and_tasks.h"
+#include "CMatrix.h"
+#include "CInt.h"
+
+/* Computes the symmetric matrix C = A * A^T, or C = A^T * A if the
+   second input is nonzero, for a general matrix A. Only the upper
+   block triangle of C is computed and stored, see CMatrix::symmetric.
+   The leaf kernel is dsyrk, so the work is about half of that of a
+   general multiply. */
+struct MatrixSyrk: public cht::Task {
+  cht::ID execute(CMatrix const &, CInt const &);
+  CHT_TASK_INPUT((CMatrix, CInt));
+  CHT_TASK_OUTPUT((CMatrix));
+  CHT_TASK_TYPE_DECLARATION;
+};
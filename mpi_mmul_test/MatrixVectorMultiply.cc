@@ -0,0 +1,56 @@
+#include "MatrixVectorMultiply.h"
+#include "TaskProfile.h"
+#include <algorithm>
+#include "MatrixLeafKernels.h"
+#include "VectorAdd.h"
+#include "CreateVectorFromIds.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((MatrixVectorMultiply));
+cht::ID MatrixVectorMultiply::execute(CMatrix const & M, CVector const & x, CInt const & transpose) {
+  TaskProfileScope profile("MatrixVectorMultiply", M.n);
+  if(M.n != x.n || M.blockSize != x.blockSize)
+    throw std::runtime_error("Error in MatrixVectorMultiply::execute: (M.n != x.n || M.blockSize != x.blockSize).");
+  int n = M.n;
+  if(M.isLeaf()) {
+    // Lowest level
+    CVector* y = new CVector();
+    y->n = n;
+    y->blockSize = M.blockSize;
+    y->elements.resize(n);
+    LeafBuffer tmpM;
+    leaf_matvec(n, M.getDoubleElements(tmpM), &x.elements[0], transpose != 0, &y->elements[0]);
+    profile.addFlops(2.0*n*n);
+    return registerChunk(y, cht::persistent);
+  }
+  else {
+    // Not lowest level
+    cht::ID childTaskIDs[2];
+    for(int i = 0; i < 2; i++) {
+      // y_i = sum over k of M_ik * x_k, or M_ki^T * x_k if transposed
+      cht::ID productIDs[2];
+      int nProducts = 0;
+      for(int k = 0; k < 2; k++) {
+	cht::ChunkID cid_M_child = transpose ? M.children[k*2+i] : M.children[i*2+k];
+	cht::ChunkID cid_transpose = getInputChunkID(transpose);
+	if(M.symmetric) {
+	  // M^T = M, and the lower block is the transpose of the upper one
+	  cid_M_child = M.children[std::min(i,k)*2+std::max(i,k)];
+	  if(cid_M_child != cht::CHUNK_ID_NULL && x.children[k] != cht::CHUNK_ID_NULL)
+	    cid_transpose = registerChunk( new CInt(i > k ? 1 : 0) );
+	}
+	if(cid_M_child == cht::CHUNK_ID_NULL || x.children[k] == cht::CHUNK_ID_NULL)
+	  continue;
+	productIDs[nProducts++] = registerTask<MatrixVectorMultiply>(cid_M_child, x.children[k], cid_transpose);
+      }
+      if(nProducts == 0)
+	childTaskIDs[i] = cht::CHUNK_ID_NULL;
+      else if(nProducts == 1)
+	childTaskIDs[i] = productIDs[0];
+      else
+	childTaskIDs[i] = registerTask<VectorAdd>(productIDs[0], productIDs[1]);
+    }
+    cht::ChunkID cid_n = registerChunk( new CInt(n) );
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(M.blockSize) );
+    return registerTask<CreateVectorFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], cht::persistent);
+  }
+} // end execute
@@ -0,0 +1,14 @@
+#include "chunks_and_tasks.h"
+#include "CInt.h"
+#include "CMatrix.h"
+#include "CVector.h"
+
+/* Computes y = M * x, or y = M^T * x if the third input is nonzero.
+   Products involving zero (CHUNK_ID_NULL) children of M or x are
+   skipped, and the result is CHUNK_ID_NULL if all of y is zero. */
+struct MatrixVectorMultiply: public cht::Task {
+  cht::ID execute(CMatrix const &, CVector const &, CInt const &);
+  CHT_TASK_INPUT((CMatrix, CVector, CInt));
+  CHT_TASK_OUTPUT((CVector));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,27 @@
+#include "MergeProcessStatistics.h"
+#include "GetProcessStatistics.h"
+#include "TaskProfile.h"
+#include <algorithm>
+
+CHT_TASK_TYPE_IMPLEMENTATION((MergeProcessStatistics));
+cht::ID MergeProcessStatistics::execute(CVector const & stats1, CVector const & stats2) {
+  TaskProfileScope profile("MergeProcessStatistics", 0);
+  const int rowSize = 1 + PROCESS_STAT_COUNT;
+  std::vector<double> rows = stats1.elements;
+  for(int j = 0; j < stats2.n; j += rowSize) {
+    double const * row = &stats2.elements[j];
+    int i = 0;
+    while(i < (int)rows.size() && rows[i] != row[0])
+      i += rowSize;
+    if(i == (int)rows.size())
+      rows.insert(rows.end(), row, row + rowSize);
+    else
+      for(int k = 1; k < rowSize; k++)
+	rows[i+k] = std::max(rows[i+k], row[k]);
+  }
+  CVector* v = new CVector();
+  v->n = rows.size();
+  v->blockSize = v->n;
+  v->elements = rows;
+  return registerChunk(v, cht::persistent);
+} // end execute
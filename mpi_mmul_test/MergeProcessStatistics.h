@@ -0,0 +1,12 @@
+#include "chunks_and_tasks.h"
+#include "CVector.h"
+
+/* Merges two results of GetProcessStatistics. A process reached more
+   than once gets the maximum of each value, i.e. the values from
+   before any reset. */
+struct MergeProcessStatistics: public cht::Task {
+  cht::ID execute(CVector const &, CVector const &);
+  CHT_TASK_INPUT((CVector, CVector));
+  CHT_TASK_OUTPUT((CVector));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,75 @@
+#include "SaveMatrix.h"
+#include "TaskProfile.h"
+#include "AddDoubles.h"
+#include <cstring>
+#include <unistd.h>
+
+CHT_TASK_TYPE_IMPLEMENTATION((SaveMatrix));
+cht::ID SaveMatrix::execute(CMatrix const & A, CInt const & baseIdx1, CInt const & baseIdx2, CMatrixFile const & file) {
+  TaskProfileScope profile("SaveMatrix", A.n);
+  MatrixFileHeader const & header = file.header;
+  int n = A.n;
+  if(A.blockSize != header.blockSize)
+    throw std::runtime_error("Error in SaveMatrix::execute: block size does not match the file.");
+  MatrixFileNode node;
+  memset(&node, 0, sizeof(node));
+  node.flags = MATRIX_FILE_NODE_PRESENT;
+  if(A.symmetric)
+    node.flags |= MATRIX_FILE_NODE_SYMMETRIC;
+  node.norm = A.norm;
+  uint64_t nodeOffset = matrix_file_node_offset(header, n, baseIdx1 / n, baseIdx2 / n);
+  if(A.isLeaf()) {
+    // Lowest level
+    if(A.leafType != header.leafType)
+      throw std::runtime_error("Error in SaveMatrix::execute: leaf type does not match the file.");
+    size_t nBytes = A.leafElementBytes();
+    node.dataOffset = matrix_file_leaf_offset(header, baseIdx1 / n, baseIdx2 / n);
+    node.checksum = matrix_file_checksum(A.elements.data(), nBytes);
+    node.leafType = A.leafType;
+    int fd = matrix_file_open(file.path, true);
+    try {
+      matrix_file_write(fd, A.elements.data(), nBytes, node.dataOffset);
+      matrix_file_write(fd, &node, sizeof(node), nodeOffset);
+    }
+    catch(...) {
+      close(fd);
+      throw;
+    }
+    close(fd);
+    return registerChunk( new CDouble(nBytes), cht::persistent);
+  }
+  else {
+    // Not lowest level. Zero children are not written.
+    int nHalf = n / 2;
+    cht::ID bytesIDs[4];
+    int nChildren = 0;
+    for(int i = 0; i < 4; i++) {
+      node.childNorms[i] = A.childNorms[i];
+      if(A.children[i] == cht::CHUNK_ID_NULL)
+	continue;
+      node.flags |= MATRIX_FILE_NODE_CHILD << i;
+      cht::ChunkID cid_baseIdx1 = registerChunk( new CInt(baseIdx1 + (i/2)*nHalf) );
+      cht::ChunkID cid_baseIdx2 = registerChunk( new CInt(baseIdx2 + (i%2)*nHalf) );
+      bytesIDs[nChildren++] = registerTask<SaveMatrix>(A.children[i], cid_baseIdx1, cid_baseIdx2, getInputChunkID(file));
+    }
+    int fd = matrix_file_open(file.path, true);
+    try {
+      matrix_file_write(fd, &node, sizeof(node), nodeOffset);
+    }
+    catch(...) {
+      close(fd);
+      throw;
+    }
+    close(fd);
+    if(nChildren == 0)
+      return registerChunk( new CDouble(0), cht::persistent);
+    // Sum of the bytes written by the children
+    if(nChildren == 1)
+      bytesIDs[nChildren++] = registerChunk( new CDouble(0) );
+    while(nChildren > 2) {
+      bytesIDs[nChildren-2] = registerTask<AddDoubles>(bytesIDs[nChildren-2], bytesIDs[nChildren-1]);
+      nChildren--;
+    }
+    return registerTask<AddDoubles>(bytesIDs[0], bytesIDs[1], cht::persistent);
+  }
+} // end execute
@@ -0,0 +1,18 @@
+#include "chunks_and_tasks.h"
+#include "CInt.h"
+#include "CDouble.h"
+#include "CMatrix.h"
+#include "CMatrixFile.h"
+
+/* Writes the matrix, whose top left element is (baseIdx1, baseIdx2)
+   in the whole matrix, to a file created by matrix_file_create. Each
+   node writes its own entry of the node index and each leaf its
+   elements, in tasks of their own. Returns the number of leaf element
+   bytes written. The file gets its checksums from
+   matrix_file_finalize after this. */
+struct SaveMatrix: public cht::Task {
+  cht::ID execute(CMatrix const &, CInt const &, CInt const &, CMatrixFile const &);
+  CHT_TASK_INPUT((CMatrix, CInt, CInt, CMatrixFile));
+  CHT_TASK_OUTPUT((CDouble));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,179 @@
+#include "TaskProfile.h"
+#include <atomic>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdlib>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+struct TaskProfileEvent {
+  char const * name; // string literal given to TaskProfileScope
+  int n;
+  int thread;
+  double startTime;
+  double endTime;
+  double flops;
+  size_t bytesSerialized;
+  size_t bytesDeserialized;
+};
+
+// Events are written when this many have been recorded, or when the oldest is this old
+static const size_t FLUSH_EVENT_COUNT = 100000;
+static const double FLUSH_SECONDS = 10;
+
+/* Events are coarse (one per task) so a single mutex is enough. They
+   are written in batches as they are recorded, so that the memory use
+   stays bounded and a process killed by the runtime loses at most
+   the last batch, and the object writes the remaining events when the
+   process exits. Full batches are handed to a writer thread, so that
+   the file I/O is not done inside a task or a serialization call and
+   does not add to the times being profiled. */
+class TaskProfileLog {
+ public:
+  TaskProfileLog() : firstEventTime(0), stopWriter(false) {
+    char const * prefix = getenv("TASK_PROFILE");
+    enabled = prefix != 0 && prefix[0] != '\0';
+    if(enabled)
+      filePrefix = prefix;
+  }
+  ~TaskProfileLog() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopWriter = true;
+    }
+    cond.notify_one();
+    if(writer.joinable())
+      writer.join();
+    flush();
+  }
+  void add(TaskProfileEvent const & event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(events.empty())
+      firstEventTime = event.endTime;
+    events.push_back(event);
+    if(events.size() < FLUSH_EVENT_COUNT && event.endTime - firstEventTime < FLUSH_SECONDS)
+      return;
+    pending.push_back(std::vector<TaskProfileEvent>());
+    pending.back().swap(events);
+    if(!writer.joinable())
+      writer = std::thread(&TaskProfileLog::writerLoop, this);
+    cond.notify_one();
+  }
+  // Writes the pending batches and the events not yet in a batch, in the calling thread
+  void flush() {
+    std::vector<std::vector<TaskProfileEvent> > batches;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      batches.swap(pending);
+      batches.push_back(std::vector<TaskProfileEvent>());
+      batches.back().swap(events);
+    }
+    for(size_t i = 0; i < batches.size(); i++)
+      write(batches[i]);
+  }
+  bool enabled;
+ private:
+  void writerLoop();
+  void write(std::vector<TaskProfileEvent> const & batch);
+  std::string filePrefix;
+  std::mutex mutex;
+  std::vector<TaskProfileEvent> events;
+  double firstEventTime;
+  // Full batches waiting for the writer thread
+  std::vector<std::vector<TaskProfileEvent> > pending;
+  std::condition_variable cond;
+  std::thread writer;
+  bool stopWriter;
+  // Held while writing, so that batches are not interleaved in the file
+  std::mutex fileMutex;
+};
+
+void TaskProfileLog::writerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while(true) {
+    cond.wait(lock, [this]() { return stopWriter || !pending.empty(); });
+    if(pending.empty())
+      return;
+    std::vector<std::vector<TaskProfileEvent> > batches;
+    batches.swap(pending);
+    lock.unlock();
+    for(size_t i = 0; i < batches.size(); i++)
+      write(batches[i]);
+    lock.lock();
+  }
+}
+
+void TaskProfileLog::write(std::vector<TaskProfileEvent> const & batch) {
+  if(!enabled || batch.empty())
+    return;
+  std::lock_guard<std::mutex> lock(fileMutex);
+  char hostName[256];
+  if(gethostname(hostName, sizeof(hostName)) != 0)
+    snprintf(hostName, sizeof(hostName), "unknown");
+  hostName[sizeof(hostName)-1] = '\0';
+  char fileName[1024];
+  snprintf(fileName, sizeof(fileName), "%s.%s.%d.events", filePrefix.c_str(), hostName, (int)getpid());
+  // Appended, since each batch is written separately
+  FILE* f = fopen(fileName, "a");
+  if(!f) {
+    fprintf(stderr, "Warning: failed to open task profile file '%s'.\n", fileName);
+    return;
+  }
+  for(size_t i = 0; i < batch.size(); i++) {
+    TaskProfileEvent const & e = batch[i];
+    fprintf(f, "%s %d %d %.9f %.9f %.0f %zu %zu\n", e.name, e.n, e.thread, e.startTime, e.endTime,
+	    e.flops, e.bytesSerialized, e.bytesDeserialized);
+  }
+  fclose(f);
+}
+
+static TaskProfileLog & get_log() {
+  static TaskProfileLog log;
+  return log;
+}
+
+static double get_profile_time() {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// Small thread numbers in the order threads first record an event
+static int get_thread_index() {
+  static std::atomic<int> nThreads(0);
+  static thread_local int idx = nThreads.fetch_add(1);
+  return idx;
+}
+
+bool task_profile_enabled() {
+  return get_log().enabled;
+}
+
+void task_profile_flush() {
+  get_log().flush();
+}
+
+TaskProfileScope::TaskProfileScope(char const * name_, int n_)
+  : name(name_), n(n_), startTime(0), flops(0), bytesSerialized(0), bytesDeserialized(0) {
+  if(task_profile_enabled())
+    startTime = get_profile_time();
+}
+
+TaskProfileScope::~TaskProfileScope() {
+  if(!task_profile_enabled())
+    return;
+  TaskProfileEvent event;
+  event.name = name;
+  event.n = n;
+  event.thread = get_thread_index();
+  event.startTime = startTime;
+  event.endTime = get_profile_time();
+  event.flops = flops;
+  event.bytesSerialized = bytesSerialized;
+  event.bytesDeserialized = bytesDeserialized;
+  get_log().add(event);
+}
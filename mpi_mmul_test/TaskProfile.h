@@ -0,0 +1,40 @@
+#ifndef TASKPROFILE_HEADER
+#define TASKPROFILE_HEADER
+
+#include <cstddef>
+
+/* Per-process profile of task executions and CMatrix serialization.
+   Profiling is enabled by setting the environment variable
+   TASK_PROFILE to a file name prefix. Each process then records one
+   event per task execute or (de)serialization and appends them to
+   PREFIX.HOST.PID.events in batches, every 100000 events or 10
+   seconds, and when it exits. The batches are written by a background
+   thread, outside the recorded intervals. The profile_report program
+   merges those files into a Chrome trace JSON file and prints a
+   summary. If TASK_PROFILE is not set the overhead is one test of a
+   flag per event. Times are taken from CLOCK_REALTIME so that events
+   from different processes can be put on the same time axis. */
+bool task_profile_enabled();
+// Writes the events recorded so far and clears them
+void task_profile_flush();
+
+/* Records one event covering the lifetime of the object. n is the
+   matrix or vector size the task works on, or 0. */
+class TaskProfileScope {
+ public:
+  TaskProfileScope(char const * name_, int n_);
+  ~TaskProfileScope();
+  void setSize(int n_) { n = n_; }
+  void addFlops(double f) { flops += f; }
+  void addBytesSerialized(size_t b) { bytesSerialized += b; }
+  void addBytesDeserialized(size_t b) { bytesDeserialized += b; }
+ private:
+  char const * name;
+  int n;
+  double startTime;
+  double flops;
+  size_t bytesSerialized;
+  size_t bytesDeserialized;
+};
+
+#endif
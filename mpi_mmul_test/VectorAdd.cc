@@ -0,0 +1,15 @@
+#include "VectorAdd.h"
+#include "TaskProfile.h"
+#include "VectorAddNonNull.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((VectorAdd));
+cht::ID VectorAdd::execute(cht::ChunkID const & x, cht::ChunkID const & y) {
+  TaskProfileScope profile("VectorAdd", 0);
+  if(x == cht::CHUNK_ID_NULL && y == cht::CHUNK_ID_NULL)
+    return cht::CHUNK_ID_NULL;
+  if(x == cht::CHUNK_ID_NULL)
+    return copyChunk(y);
+  if(y == cht::CHUNK_ID_NULL)
+    return copyChunk(x);
+  return registerTask<VectorAddNonNull>(x, y, cht::persistent);
+} // end execute
@@ -0,0 +1,12 @@
+#include "chunks_and_tasks.h"
+#include "CVector.h"
+
+/* Computes x + y where either of x and y may be CHUNK_ID_NULL,
+   meaning an all-zero vector. If one operand is zero the other one is
+   forwarded, otherwise the work is done by VectorAddNonNull. */
+struct VectorAdd: public cht::Task {
+  cht::ID execute(cht::ChunkID const &, cht::ChunkID const &);
+  CHT_TASK_INPUT((cht::ChunkID, cht::ChunkID));
+  CHT_TASK_OUTPUT((CVector));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,31 @@
+#include "VectorAddNonNull.h"
+#include "TaskProfile.h"
+#include "VectorAdd.h"
+#include "CreateVectorFromIds.h"
+
+CHT_TASK_TYPE_IMPLEMENTATION((VectorAddNonNull));
+cht::ID VectorAddNonNull::execute(CVector const & x, CVector const & y) {
+  TaskProfileScope profile("VectorAddNonNull", x.n);
+  if(x.n != y.n || x.blockSize != y.blockSize)
+    throw std::runtime_error("Error in VectorAddNonNull::execute: (x.n != y.n || x.blockSize != y.blockSize).");
+  int n = x.n;
+  if(x.isLeaf()) {
+    // Lowest level
+    CVector* z = new CVector();
+    z->n = n;
+    z->blockSize = x.blockSize;
+    z->elements.resize(n);
+    for(int i = 0; i < n; i++)
+      z->elements[i] = x.elements[i] + y.elements[i];
+    return registerChunk(z, cht::persistent);
+  }
+  else {
+    // Not lowest level. Children may be CHUNK_ID_NULL, that is handled by VectorAdd.
+    cht::ID childTaskIDs[2];
+    for(int i = 0; i < 2; i++)
+      childTaskIDs[i] = registerTask<VectorAdd>(x.children[i], y.children[i]);
+    cht::ChunkID cid_n = registerChunk( new CInt(n) );
+    cht::ChunkID cid_blockSize = registerChunk( new CInt(x.blockSize) );
+    return registerTask<CreateVectorFromIds>(cid_n, cid_blockSize, childTaskIDs[0], childTaskIDs[1], cht::persistent);
+  }
+} // end execute
@@ -0,0 +1,9 @@
+#include "chunks_and_tasks.h"
+#include "CVector.h"
+
+struct VectorAddNonNull: public cht::Task {
+  cht::ID execute(CVector const &, CVector const &);
+  CHT_TASK_INPUT((CVector, CVector));
+  CHT_TASK_OUTPUT((CVector));
+  CHT_TASK_TYPE_DECLARATION;
+};
@@ -0,0 +1,105 @@
+/* Micro-benchmark for serialization of CMatrix leaves, i.e. the
+   CMatrix::writeToBuffer and CMatrix::assignFromBuffer calls done by
+   the runtime for each chunk transfer or cache fill. For comparison
+   the same is also done with a plain std::vector<double>, the way
+   leaves were stored before. The leaf is filled with the smooth test
+   matrix A of test_matrix, and the throughput and compression ratio
+   of the leaf codec (LeafCodec.h) are measured on it as well. */
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <stdio.h>
+#include <stdlib.h>
+#include "CMatrix.h"
+#include "LeafCodec.h"
+#include "MatrixElementValues.h"
+#include "bench_timing.h"
+
+int main(int argc, char* const argv[])
+{
+  if(argc != 3) {
+    std::cout << "Please give 2 arguments: blockSize nRepetitions" << std::endl;
+    return -1;
+  }
+  int n = atoi(argv[1]);
+  int nRepetitions = atoi(argv[2]);
+  if(n <= 0 || nRepetitions <= 0) {
+    std::cout << "Error: (blockSize <= 0 || nRepetitions <= 0)." << std::endl;
+    return -1;
+  }
+  CMatrix A;
+  A.n = n;
+  A.blockSize = n;
+  A.elements.resize(n*n);
+  for(int i = 0; i < n; i++)
+    for(int j = 0; j < n; j++)
+      A.elements[i*n+j] = matElementFunc(MATRIX_TYPE_A, i, j);
+  size_t bufferSize = A.getSize();
+  std::vector<char> buffer(bufferSize);
+  double GB_per_repetition = (double)n*n*sizeof(double) / 1e9;
+
+  // CMatrix::writeToBuffer. With LEAF_COMPRESSION=1 the leaf is
+  // encoded once, by getSize above, and then only copied.
+  double startTime = bench_seconds();
+  for(int rep = 0; rep < nRepetitions; rep++)
+    A.writeToBuffer(&buffer[0], bufferSize);
+  double timeTaken_write = bench_seconds() - startTime;
+
+  // CMatrix::assignFromBuffer into a new chunk each time, as the
+  // runtime does when a chunk is fetched
+  startTime = bench_seconds();
+  for(int rep = 0; rep < nRepetitions; rep++) {
+    CMatrix B;
+    B.assignFromBuffer(&buffer[0], bufferSize);
+    if(B.elements[n*n-1] != A.elements[n*n-1]) {
+      std::cout << "Error: wrong data after assignFromBuffer." << std::endl;
+      return -1;
+    }
+  }
+  double timeTaken_assign = bench_seconds() - startTime;
+
+  // Same thing with std::vector resize + memcpy
+  startTime = bench_seconds();
+  for(int rep = 0; rep < nRepetitions; rep++) {
+    std::vector<double> v;
+    v.resize(n*n);
+    memcpy(&v[0], A.elements.data(), n*n*sizeof(double));
+    if(v[n*n-1] != A.elements[n*n-1]) {
+      std::cout << "Error: wrong data after memcpy." << std::endl;
+      return -1;
+    }
+  }
+  double timeTaken_vector = bench_seconds() - startTime;
+
+  // Leaf codec, encode and decode, checking that the result is exact
+  std::vector<char> encoded;
+  size_t encodedBytes = 0;
+  startTime = bench_seconds();
+  for(int rep = 0; rep < nRepetitions; rep++) {
+    encoded.clear();
+    encodedBytes = leaf_codec_encode((char const *)&A.elements[0], n*n*sizeof(double), sizeof(double), encoded);
+  }
+  double timeTaken_encode = bench_seconds() - startTime;
+  LeafBuffer decoded;
+  decoded.resize(n*n);
+  startTime = bench_seconds();
+  for(int rep = 0; rep < nRepetitions; rep++)
+    leaf_codec_decode(&encoded[0], encodedBytes, sizeof(double), (char*)decoded.data(), n*n*sizeof(double));
+  double timeTaken_decode = bench_seconds() - startTime;
+  if(memcmp(decoded.data(), A.elements.data(), n*n*sizeof(double)) != 0) {
+    std::cout << "Error: leaf codec did not reproduce the elements exactly." << std::endl;
+    return -1;
+  }
+
+  printf("blockSize = %d, leaf size = %.3f MB, nRepetitions = %d\n", n, GB_per_repetition*1000, nRepetitions);
+  printf("writeToBuffer            %8.3f GB/s\n", nRepetitions*GB_per_repetition / timeTaken_write);
+  printf("assignFromBuffer         %8.3f GB/s\n", nRepetitions*GB_per_repetition / timeTaken_assign);
+  printf("std::vector resize+copy  %8.3f GB/s\n", nRepetitions*GB_per_repetition / timeTaken_vector);
+  printf("leaf codec encode        %8.3f GB/s\n", nRepetitions*GB_per_repetition / timeTaken_encode);
+  printf("leaf codec decode        %8.3f GB/s\n", nRepetitions*GB_per_repetition / timeTaken_decode);
+  printf("leaf codec compression ratio %.3f (%zu -> %zu bytes)\n", (double)n*n*sizeof(double) / encodedBytes,
+	 n*n*sizeof(double), encodedBytes);
+  printf("elements 64-byte aligned: %s\n", ((size_t)&A.elements[0] % LEAF_MEMORY_ALIGNMENT) == 0 ? "yes" : "no");
+  return 0;
+}
@@ -1,3 +1,10 @@
 git clone https://github.com/UPPMAX/OpenBLAS.git
 cd OpenBLAS
-make USE_THREAD=0
+# OpenMP build, the number of BLAS threads per leaf dgemm call is
+# set at run time with LEAF_BLAS_THREADS (default 1). With OpenMP
+# several worker threads can call OpenBLAS at the same time, each with
+# its own BLAS threads; NUM_PARALLEL is the largest number of such
+# concurrent calls, so it must be at least the number of worker
+# threads per process (needs OpenBLAS 0.3.7 or later). The pthreads
+# build (USE_THREAD=1 only) is rejected for LEAF_BLAS_THREADS > 1.
+make USE_THREAD=1 USE_OPENMP=1 NUM_PARALLEL=64
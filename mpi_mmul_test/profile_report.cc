@@ -0,0 +1,215 @@
+/* Reads the task profile files written by the processes of a
+   test_matrix run with TASK_PROFILE=prefix set (see TaskProfile.h),
+   writes them as one Chrome trace JSON file that can be opened in
+   chrome://tracing or https://ui.perfetto.dev, and prints a summary:
+   time, FLOPs and bytes per task type, busy and idle time per
+   process, load imbalance, and a rough critical path estimate. */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <glob.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct ProfileEvent {
+  std::string name;
+  int n;
+  int process;
+  int thread;
+  double startTime;
+  double endTime;
+  double flops;
+  double bytesSerialized;
+  double bytesDeserialized;
+};
+
+struct TypeSummary {
+  TypeSummary() : count(0), seconds(0), maxSeconds(0), flops(0), bytesSerialized(0), bytesDeserialized(0) { }
+  long int count;
+  double seconds;
+  double maxSeconds;
+  double flops;
+  double bytesSerialized;
+  double bytesDeserialized;
+};
+
+// Serialization events are named ChunkType::function
+static bool is_serialization(std::string const & name) {
+  return name.find("::") != std::string::npos;
+}
+
+/* Total length of the union of the intervals, so that nested events
+   (e.g. serialization inside a task) are not counted twice. */
+static double get_busy_seconds(std::vector<std::pair<double, double> > intervals) {
+  std::sort(intervals.begin(), intervals.end());
+  double busy = 0;
+  double currentEnd = -1e300;
+  for(size_t i = 0; i < intervals.size(); i++) {
+    double start = std::max(intervals[i].first, currentEnd);
+    if(intervals[i].second > start)
+      busy += intervals[i].second - start;
+    currentEnd = std::max(currentEnd, intervals[i].second);
+  }
+  return busy;
+}
+
+static int read_events(std::string const & fileName, int process, std::vector<ProfileEvent> & events) {
+  std::ifstream f(fileName.c_str());
+  if(!f) {
+    std::cout << "Error: failed to open '" << fileName << "'." << std::endl;
+    return -1;
+  }
+  std::string line;
+  while(std::getline(f, line)) {
+    std::istringstream ss(line);
+    ProfileEvent e;
+    e.process = process;
+    if(!(ss >> e.name >> e.n >> e.thread >> e.startTime >> e.endTime >> e.flops >> e.bytesSerialized >> e.bytesDeserialized)) {
+      std::cout << "Error: bad line in '" << fileName << "': " << line << std::endl;
+      return -1;
+    }
+    events.push_back(e);
+  }
+  return 0;
+}
+
+static int write_chrome_trace(std::string const & traceFileName, std::vector<ProfileEvent> const & events,
+			      std::vector<std::string> const & processNames, double t0) {
+  FILE* f = fopen(traceFileName.c_str(), "w");
+  if(!f) {
+    std::cout << "Error: failed to open '" << traceFileName << "' for writing." << std::endl;
+    return -1;
+  }
+  fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  for(size_t p = 0; p < processNames.size(); p++)
+    fprintf(f, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"args\": {\"name\": \"%s\"}},\n",
+	    (int)p, processNames[p].c_str());
+  for(size_t i = 0; i < events.size(); i++) {
+    ProfileEvent const & e = events[i];
+    // Times in microseconds relative to the first event
+    fprintf(f, "{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": %d, \"tid\": %d, "
+	    "\"args\": {\"n\": %d, \"flops\": %.0f, \"bytesSerialized\": %.0f, \"bytesDeserialized\": %.0f}}%s\n",
+	    e.name.c_str(), is_serialization(e.name) ? "serialization" : "task",
+	    (e.startTime - t0) * 1e6, (e.endTime - e.startTime) * 1e6, e.process, e.thread,
+	    e.n, e.flops, e.bytesSerialized, e.bytesDeserialized, i+1 < events.size() ? "," : "");
+  }
+  fprintf(f, "]}\n");
+  fclose(f);
+  return 0;
+}
+
+int main(int argc, char* const argv[])
+{
+  if(argc != 2 && argc != 3) {
+    std::cout << "Please give 1 or 2 arguments: prefix [traceFile]" << std::endl;
+    std::cout << "     prefix: the TASK_PROFILE value used for the run, files prefix.*.events are read" << std::endl;
+    std::cout << "     traceFile: Chrome trace JSON output file (default prefix.json)" << std::endl;
+    return -1;
+  }
+  std::string prefix = argv[1];
+  std::string traceFileName = argc == 3 ? argv[2] : prefix + ".json";
+  glob_t globResult;
+  std::string pattern = prefix + ".*.events";
+  if(glob(pattern.c_str(), 0, NULL, &globResult) != 0) {
+    std::cout << "Error: no files matching '" << pattern << "'." << std::endl;
+    return -1;
+  }
+  std::vector<ProfileEvent> events;
+  std::vector<std::string> processNames;
+  std::string suffix = ".events";
+  for(size_t i = 0; i < globResult.gl_pathc; i++) {
+    std::string fileName = globResult.gl_pathv[i];
+    // The process is named HOST.PID as in the file name
+    processNames.push_back(fileName.substr(prefix.size()+1, fileName.size() - prefix.size() - 1 - suffix.size()));
+    if(read_events(fileName, i, events) != 0)
+      return -1;
+  }
+  globfree(&globResult);
+  if(events.empty()) {
+    std::cout << "Error: no events found." << std::endl;
+    return -1;
+  }
+  double t0 = events[0].startTime;
+  double t1 = events[0].endTime;
+  for(size_t i = 0; i < events.size(); i++) {
+    t0 = std::min(t0, events[i].startTime);
+    t1 = std::max(t1, events[i].endTime);
+  }
+  double wallSeconds = t1 - t0;
+  if(write_chrome_trace(traceFileName, events, processNames, t0) != 0)
+    return -1;
+  std::cout << "Wrote " << events.size() << " events from " << processNames.size() << " processes to " << traceFileName << std::endl;
+
+  // Per task type
+  std::map<std::string, TypeSummary> types;
+  double totalTaskSeconds = 0;
+  for(size_t i = 0; i < events.size(); i++) {
+    ProfileEvent const & e = events[i];
+    TypeSummary & t = types[e.name];
+    double seconds = e.endTime - e.startTime;
+    t.count++;
+    t.seconds += seconds;
+    t.maxSeconds = std::max(t.maxSeconds, seconds);
+    t.flops += e.flops;
+    t.bytesSerialized += e.bytesSerialized;
+    t.bytesDeserialized += e.bytesDeserialized;
+    if(!is_serialization(e.name))
+      totalTaskSeconds += seconds;
+  }
+  printf("Task type                          count  total [s]  %% of task  mean [ms]   max [ms]  GFLOP/s  ser. [MB] deser. [MB]\n");
+  for(std::map<std::string, TypeSummary>::const_iterator it = types.begin(); it != types.end(); it++) {
+    TypeSummary const & t = it->second;
+    printf("%-30s %9ld %10.3f %10.1f %10.3f %10.3f %8.2f %10.1f %11.1f\n", it->first.c_str(), t.count, t.seconds,
+	   is_serialization(it->first) || totalTaskSeconds == 0 ? 0 : 100 * t.seconds / totalTaskSeconds,
+	   1e3 * t.seconds / t.count, 1e3 * t.maxSeconds,
+	   t.seconds > 0 ? t.flops / t.seconds / 1e9 : 0, t.bytesSerialized / 1e6, t.bytesDeserialized / 1e6);
+  }
+
+  // Per process. Only threads that recorded events are known, idle
+  // time is relative to those.
+  std::vector<double> busySeconds(processNames.size());
+  printf("\nProcess                          threads   busy [s]   idle %%\n");
+  for(size_t p = 0; p < processNames.size(); p++) {
+    std::map<int, std::vector<std::pair<double, double> > > threadIntervals;
+    for(size_t i = 0; i < events.size(); i++)
+      if(events[i].process == (int)p)
+	threadIntervals[events[i].thread].push_back(std::make_pair(events[i].startTime, events[i].endTime));
+    for(std::map<int, std::vector<std::pair<double, double> > >::const_iterator it = threadIntervals.begin(); it != threadIntervals.end(); it++)
+      busySeconds[p] += get_busy_seconds(it->second);
+    double available = wallSeconds * threadIntervals.size();
+    printf("%-32s %7d %10.3f %8.1f\n", processNames[p].c_str(), (int)threadIntervals.size(), busySeconds[p],
+	   available > 0 ? 100 * (1 - busySeconds[p] / available) : 0);
+  }
+  double maxBusy = *std::max_element(busySeconds.begin(), busySeconds.end());
+  double meanBusy = 0;
+  for(size_t p = 0; p < busySeconds.size(); p++)
+    meanBusy += busySeconds[p] / busySeconds.size();
+  printf("Wall time from first to last event: %.3f s\n", wallSeconds);
+  printf("Load imbalance (max / mean busy time over processes): %.3f\n", meanBusy > 0 ? maxBusy / meanBusy : 0);
+
+  /* The dependencies between tasks are not recorded. As an estimate
+     of the critical path of the task tree of each type, take the sum
+     over tree levels of the longest task of that type at each level.
+     Paths that go through several task types are not included. */
+  std::map<std::string, std::map<int, double> > levelMax;
+  for(size_t i = 0; i < events.size(); i++) {
+    ProfileEvent const & e = events[i];
+    if(is_serialization(e.name) || e.n <= 0)
+      continue;
+    double & m = levelMax[e.name][e.n];
+    m = std::max(m, e.endTime - e.startTime);
+  }
+  printf("\nCritical path estimate per task type (sum over tree levels of the longest task):\n");
+  for(std::map<std::string, std::map<int, double> >::const_iterator it = levelMax.begin(); it != levelMax.end(); it++) {
+    double criticalPath = 0;
+    for(std::map<int, double>::const_iterator jt = it->second.begin(); jt != it->second.end(); jt++)
+      criticalPath += jt->second;
+    printf("%-30s %10.3f ms over %d levels\n", it->first.c_str(), 1e3 * criticalPath, (int)it->second.size());
+  }
+  return 0;
+}
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Runs an iterative test_matrix workload once for each given chunk
+# cache size, to see how per-iteration time and cache hits depend on
+# the cache size. Set BENCH_RESULTS to collect one record per run.
+# Usage: ./run_cache_sweep.sh N nWorkerProcs nThreads workload iterations cacheInGB1 [cacheInGB2 ...] [-- name=value ...]
+if [ $# -lt 6 ]; then
+    echo "Usage: $0 N nWorkerProcs nThreads workload iterations cacheInGB1 [cacheInGB2 ...] [-- name=value ...]"
+    echo "  workload is one of square, power, polynomial. A negative cache size disables the cache."
+    exit 1
+fi
+N=$1
+NWORKERS=$2
+NTHREADS=$3
+WORKLOAD=$4
+ITERATIONS=$5
+shift 5
+CACHESIZES=""
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    CACHESIZES="$CACHESIZES $1"
+    shift
+done
+[ "$1" = "--" ] && shift
+for CACHE in $CACHESIZES; do
+    echo "=== cacheInGB = $CACHE ==="
+    mpirun -np 1 ./test_matrix_manager $N $NWORKERS $NTHREADS $CACHE workload=$WORKLOAD iterations=$ITERATIONS "$@" || exit 1
+done
@@ -0,0 +1,53 @@
+#!/bin/sh
+# Tries combinations of worker processes, worker threads per process
+# and BLAS threads per leaf dgemm call (LEAF_BLAS_THREADS) for one
+# test_matrix case, and prints the multiply time for each combination
+# followed by the best one. Combinations needing more than maxCores
+# cores, i.e. nWorkerProcs*nThreads*blasThreads > maxCores, are
+# skipped. maxCores is per node when the worker processes are spread
+# over several nodes, with nWorkerProcs then being processes per node
+# times the number of nodes. blasThreads > 1 needs OpenBLAS built with
+# OpenMP, see prepare_openblas.sh. Runs that fail, e.g. in the
+# verification, are reported and left out.
+# Usage: ./tune_threads.sh N cacheInGB maxCores "procsList" "threadsList" "blasThreadsList" [name=value ...]
+if [ $# -lt 6 ]; then
+    echo "Usage: $0 N cacheInGB maxCores \"procsList\" \"threadsList\" \"blasThreadsList\" [name=value ...]"
+    echo "  example: $0 8000 2 20 \"1 2 4\" \"1 2 5 10 20\" \"1 2 4\" blockSize=1000"
+    exit 1
+fi
+N=$1
+CACHE=$2
+MAXCORES=$3
+PROCSLIST=$4
+THREADSLIST=$5
+BLASLIST=$6
+shift 6
+RESULTS=$(mktemp)
+OUTPUT=$(mktemp)
+for PROCS in $PROCSLIST; do
+    for THREADS in $THREADSLIST; do
+	for BLAS in $BLASLIST; do
+	    if [ $((PROCS * THREADS * BLAS)) -gt $MAXCORES ]; then
+		continue
+	    fi
+	    echo "=== nWorkerProcs = $PROCS , nThreads = $THREADS , blasThreads = $BLAS ==="
+	    if ! LEAF_BLAS_THREADS=$BLAS mpirun -np 1 ./test_matrix_manager $N $PROCS $THREADS $CACHE "$@" > $OUTPUT 2>&1; then
+		echo "Run failed:"
+		tail -n 5 $OUTPUT
+		continue
+	    fi
+	    SECONDS_TAKEN=$(awk '/^Multiply \(.*\) took/ { print $4; exit }' $OUTPUT)
+	    if [ -z "$SECONDS_TAKEN" ]; then
+		echo "Run failed, no multiply time found."
+		continue
+	    fi
+	    echo "$PROCS $THREADS $BLAS $SECONDS_TAKEN" >> $RESULTS
+	done
+    done
+done
+echo "Full scan:"
+echo "nWorkerProcs  nThreads  blasThreads  wall seconds"
+sort -g -k 4 $RESULTS | awk '{ printf("%12d %9d %12d %13.3f\n", $1, $2, $3, $4) }'
+echo "Best configuration:"
+sort -g -k 4 $RESULTS | head -n 1 | awk '{ printf("nWorkerProcs = %d , nThreads = %d , blasThreads = %d : %.3f wall seconds\n", $1, $2, $3, $4) }'
+rm -f $RESULTS $OUTPUT
@@ -1,10 +1,14 @@
 /* This program estimates processor clock frequency by repeating a
-   simple operation (i++) that is assumed to take only one clock cycle
-   to execute.
-
-   To make this work, compile without optimization flags since
-   otherwise the compiler will probably optimize away most of the
-   work.
+   simple operation (adding to a register) that is assumed to take
+   only one clock cycle to execute. The additions form a dependency
+   chain written in inline assembly, see ../common/cycle_freq.c, so
+   optimization flags can be used. The time stamp counter and, when
+   available, perf_event_open core cycle counts are used to cross-check
+   the result, and the TSC frequency, core frequency and their ratio
+   are reported. An optional second argument gives a number of
+   repetitions; the median time is then used and the spread printed.
+   Compile for example like this:
+   gcc -O2 -I../common clock_freq_test.c ../common/cycle_freq.c ../common/bench_timing.c -lm
 
    Written by Elias Rudberg. A similar code previously used in the
    High Performance Computing and Programming course.
@@ -12,35 +16,42 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
-
-static double get_wall_seconds() {
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  double seconds = tv.tv_sec + (double)tv.tv_usec / 1000000;
-  return seconds;
-}
+#include "cycle_freq.h"
+#include "bench_timing.h"
 
 int main (int argc, char** argv) {
-  if(argc != 2) {
-    printf("Please give one argument, saying how many billions of operations to perform.\n");
+  if(argc != 2 && argc != 3) {
+    printf("Please give one argument, saying how many billions of operations to perform,\n");
+    printf("optionally followed by the number of repetitions.\n");
     return -1;
   }
   int nBillions = atoi(argv[1]);
-  printf("Hello! nBillions = %d\n", nBillions);
+  int nRepetitions = argc == 3 ? atoi(argv[2]) : 1;
+  if(nRepetitions <= 0) {
+    printf("Error: nRepetitions must be positive.\n");
+    return -1;
+  }
+  printf("Hello! nBillions = %d, nRepetitions = %d\n", nBillions, nRepetitions);
   long int N_one_billion = 1000000000;
   long int N = nBillions*N_one_billion;
-  double startTime = get_wall_seconds();
-  register long int i = 0;
-  while(i < N) {
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
+  CycleFreqResult result;
+  double* times = (double*)malloc(nRepetitions*sizeof(double));
+  int rep;
+  for(rep = 0; rep < nRepetitions; rep++) {
+    cycle_freq_run_chain(N, &result);
+    times[rep] = result.seconds;
   }
-  double timeTaken = get_wall_seconds() - startTime;
-  printf("N = %ld, timeTaken = %7.3f\n", N, timeTaken);
-  double ops_per_second = (double)N / timeTaken;
+  BenchStats stats;
+  bench_compute_stats(times, nRepetitions, &stats);
+  printf("N = %ld, timeTaken = %7.3f\n", N, stats.median);
+  if(nRepetitions > 1)
+    bench_print_stats("timeTaken", &stats, 1, "s");
+  double ops_per_second = result.nChainOps / stats.median;
   printf("--> processor clock frequency seems to be %4.2f GHz\n", ops_per_second/N_one_billion);
+  cycle_freq_print(&result, "serial case, last repetition");
+  char params[64];
+  snprintf(params, sizeof(params), "nBillions=%d", nBillions);
+  bench_write_result("clock_freq_test", "addition_chain", params, &stats);
+  free(times);
+  return 0;
 }
@@ -2,45 +2,152 @@
    with each thread doing the same thing, completely independent of
    the other threads. The actual work done is just a loop made to
    estimate processor clock frequency by repeating a simple operation
-   (i++) that is assumed to take only one clock cycle to execute.
+   (adding to a register) that is assumed to take only one clock cycle
+   to execute. The loop is a dependency chain in inline assembly, see
+   ../common/cycle_freq.c, so optimization flags can be used. The time
+   stamp counter and perf_event_open core cycles are used as
+   cross-checks.
 
-   To make this work, compile without optimization flags since
-   otherwise the compiler will probably optimize away most of the
-   work.
+   An optional third argument gives an affinity policy. The program
+   then instead does a sweep over thread counts 1, 2, ..., nThreads,
+   with each thread pinned to a CPU chosen according to the policy
+   (none, compact, scatter, cores or smt, see ../common/cpu_topology.h).
+   Each thread times its own run and reports its own frequency
+   estimate, so that turbo drop-off and SMT interference can be seen
+   as more cores are used. The detected CPU topology is printed
+   before the sweep. Topology detection and pinning is in
+   ../common/cpu_topology.c, so compile for example like this:
+   gcc -O2 -I../common threaded_clock_freq_test.c ../common/cpu_topology.c ../common/cycle_freq.c ../common/bench_timing.c -lpthread -lm
 
    Written by Elias Rudberg.
 */
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
+#include <string.h>
 #include <pthread.h>
-
-static double get_wall_seconds() {
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  double seconds = tv.tv_sec + (double)tv.tv_usec / 1000000;
-  return seconds;
-}
+#include "cpu_topology.h"
+#include "cycle_freq.h"
+#include "bench_timing.h"
 
 long int N_global = 0;
 
+/* The argument, if not NULL, is a CycleFreqResult where the
+   measurement is stored. */
 static void* thread_work_func(void* arg) {
-  register long int i = 0;
-  while(i < N_global) {
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
-    i++; i++; i++; i++; i++; i++; i++; i++; i++; i++;
+  CycleFreqResult result;
+  cycle_freq_run_chain(N_global, &result);
+  if(arg)
+    *(CycleFreqResult*)arg = result;
+  return NULL;
+}
+
+typedef struct {
+  int cpu; // -1 means not pinned
+  pthread_barrier_t* barrier;
+  CycleFreqResult result;
+} SweepThreadStruct;
+
+static void* sweep_thread_func(void* arg) {
+  SweepThreadStruct* s = (SweepThreadStruct*)arg;
+  if(s->cpu >= 0) {
+    if(pin_current_thread(s->cpu) != 0)
+      printf("Warning: pthread_setaffinity_np failed for cpu %d.\n", s->cpu);
   }
+  // Wait until all threads are pinned so that they start together
+  pthread_barrier_wait(s->barrier);
+  thread_work_func(&s->result);
+  return NULL;
+}
+
+static int do_thread_sweep(int nThreads, const char* policy) {
+  const int maxCpus = 4096;
+  CpuInfo* cpus = (CpuInfo*)malloc(maxCpus*sizeof(CpuInfo));
+  int nCpus = get_cpu_topology(cpus, maxCpus);
+  if(nCpus == 0) {
+    printf("Error: failed to get CPU topology.\n");
+    free(cpus);
+    return -1;
+  }
+  print_cpu_topology(cpus, nCpus);
+  if(!order_cpus(cpus, nCpus, policy)) {
+    printf("Error: unknown affinity policy '%s'.\n", policy);
+    free(cpus);
+    return -1;
+  }
+  int pin = strcmp(policy, "none") != 0;
+  if(pin) {
+    printf("CPU order for policy '%s':", policy);
+    int i;
+    for(i = 0; i < nCpus; i++)
+      printf(" %d", cpus[i].cpu);
+    printf("\n");
+    if(nThreads > nCpus)
+      printf("Warning: nThreads = %d > %d available CPUs, some CPUs will get more than one thread.\n", nThreads, nCpus);
+  }
+  double timeTaken_1 = 0;
+  printf("Thread sweep, policy '%s', core frequencies in GHz:\n", policy);
+  printf("  nThreads wall_seconds %% of ideal  freq_min  freq_avg  freq_max  core/TSC  per-thread cpu:freq\n");
+  int n;
+  for(n = 1; n <= nThreads; n++) {
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, n);
+    pthread_t threads[n];
+    SweepThreadStruct threadStructs[n];
+    double startTime = bench_seconds();
+    int i;
+    for(i = 0; i < n; i++) {
+      threadStructs[i].cpu = pin ? cpus[i % nCpus].cpu : -1;
+      threadStructs[i].barrier = &barrier;
+      if(pthread_create(&threads[i], NULL, sweep_thread_func, &threadStructs[i]) != 0) {
+	printf("Error: pthread_create failed.\n");
+	free(cpus);
+	return -1;
+      }
+    }
+    for(i = 0; i < n; i++) {
+      if(pthread_join(threads[i], NULL) != 0) {
+	printf("Error: pthread_join failed.\n");
+	free(cpus);
+	return -1;
+      }
+    }
+    double timeTaken = bench_seconds() - startTime;
+    pthread_barrier_destroy(&barrier);
+    if(n == 1)
+      timeTaken_1 = timeTaken;
+    double freqs[n], threadTimes[n];
+    double tscFreq_sum = 0;
+    for(i = 0; i < n; i++) {
+      freqs[i] = cycle_freq_core_ghz(&threadStructs[i].result);
+      threadTimes[i] = threadStructs[i].result.seconds;
+      tscFreq_sum += cycle_freq_tsc_ghz(&threadStructs[i].result);
+    }
+    BenchStats freqStats;
+    bench_compute_stats(freqs, n, &freqStats);
+    printf("  %8d %12.3f %10.1f %9.2f %9.2f %9.2f %9.3f ", n, timeTaken, 100.0 * (timeTaken_1 / timeTaken),
+	   freqStats.min, freqStats.mean, freqStats.max, tscFreq_sum > 0 ? freqStats.mean*n / tscFreq_sum : 0);
+    for(i = 0; i < n; i++)
+      printf(" %d:%4.2f", threadStructs[i].cpu, freqs[i]);
+    printf("\n");
+    // The recorded samples are the run times of the individual threads
+    BenchStats timeStats;
+    bench_compute_stats(threadTimes, n, &timeStats);
+    char params[128];
+    snprintf(params, sizeof(params), "nBillions=%ld nThreads=%d policy=%s", N_global / 1000000000, n, policy);
+    bench_write_result("threaded_clock_freq_test", "thread_sweep", params, &timeStats);
+  }
+  free(cpus);
+  return 0;
 }
 
 int main (int argc, char** argv) {
-  if(argc != 3) {
+  if(argc != 3 && argc != 4) {
     printf("Please give two arguments: nBillions and nThreads\n");
     printf("     nBillions: how many billions of operations each thread should perform.\n");
     printf("     nThreads: number of threads to use.\n");
+    printf("or three arguments: nBillions maxThreads affinityPolicy\n");
+    printf("     to do a sweep over 1..maxThreads threads with affinityPolicy one of none/compact/scatter/cores/smt.\n");
     return -1;
   }
   int nBillions = atoi(argv[1]);
@@ -49,18 +156,23 @@ int main (int argc, char** argv) {
   long int N_one_billion = 1000000000;
   N_global = nBillions*N_one_billion;
 
+  if(argc == 4)
+    return do_thread_sweep(nThreads, argv[3]);
+
   // Serial case
-  double startTime_serial = get_wall_seconds();
-  thread_work_func(NULL);
-  double timeTaken_serial = get_wall_seconds() - startTime_serial;
+  CycleFreqResult result_serial;
+  double startTime_serial = bench_seconds();
+  thread_work_func(&result_serial);
+  double timeTaken_serial = bench_seconds() - startTime_serial;
   printf("N_global = %ld, timeTaken_serial = %7.3f wall seconds (serial case)\n", N_global, timeTaken_serial);
-  double ops_per_second = (double)N_global / timeTaken_serial;
+  double ops_per_second = result_serial.nChainOps / result_serial.seconds;
   printf("--> processor clock frequency seems to be %4.2f GHz (serial case)\n", ops_per_second/N_one_billion);
+  cycle_freq_print(&result_serial, "serial case");
   
   // Threaded case
   int nThreadsToCreate = nThreads-1;
   printf("Now creating %d threads (in addition to main thread)...\n", nThreadsToCreate);
-  double startTime_threaded = get_wall_seconds();
+  double startTime_threaded = bench_seconds();
   pthread_t threads[nThreadsToCreate];
   int i;
   for(i = 0; i < nThreadsToCreate; i++) {
@@ -78,12 +190,20 @@ int main (int argc, char** argv) {
       return -1;
     }
   }
-  double timeTaken_threaded = get_wall_seconds() - startTime_threaded;
+  double timeTaken_threaded = bench_seconds() - startTime_threaded;
   /* If the threads were able to run without delay and did not disturb
      eachother at all, then timeTaken_threaded should be the same as
      timeTaken_serial. */
   double percentage = 100.0 * (timeTaken_serial / timeTaken_threaded);
   printf("timeTaken_threaded = %7.3f wall seconds (%5.1f %% of ideal parallel performance)\n", timeTaken_threaded, percentage);
+  char params[64];
+  BenchStats stats;
+  snprintf(params, sizeof(params), "nBillions=%d nThreads=1", nBillions);
+  bench_compute_stats(&timeTaken_serial, 1, &stats);
+  bench_write_result("threaded_clock_freq_test", "serial", params, &stats);
+  snprintf(params, sizeof(params), "nBillions=%d nThreads=%d", nBillions, nThreads);
+  bench_compute_stats(&timeTaken_threaded, 1, &stats);
+  bench_write_result("threaded_clock_freq_test", "threaded", params, &stats);
 
   return 0;
 }